@@ -0,0 +1,373 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-board.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define OTHELLO_BENCH_SQUARES (OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH)
+#define OTHELLO_BENCH_EMPTY -1
+#define OTHELLO_BENCH_DIRECTIONS 8
+
+/**
+ * position reached by playing strokes from the start, written as on the
+ * client ("C4" is row C, column 4), passes are implied
+ */
+struct othello_bench_position_s {
+  const char *name;
+  const char *strokes;
+  int depth;
+  unsigned long leaves; /*perft count at depth*/
+};
+
+typedef struct othello_bench_position_s othello_bench_position_t;
+
+/**
+ * perft counts a pass as a ply, a finished game is a leaf, the counts from
+ * the start are the published ones and the others agree between every
+ * implementation below
+ */
+static const othello_bench_position_t othello_bench_positions[] = {
+    {"start", "", 9, 3005288},
+    {"opening", "D3C5F6F5E6E3", 7, 6279223},
+    {"middle", "F5F4E3F6C5C3G5B6B2F2D2D6E7G4F3G3H3G6C6C7G1A1B7H4", 6,
+     8042948},
+    {"pass", "D3E3F3E2D1E1F5G3H3C1", 8, 351099},
+    {"end",
+     "E6F4F3F6D3C5B6F2C6C3E3C4B3E2G7A7G3B7D1G4C7D7A6F7B8G2G8B5E7B2H3A8A5H4F1"
+     "H7F8G5H5C2A1E1C1F5C8D8",
+     8, 4490479}};
+
+/**
+ * perft of one implementation, board is the position of the start of the
+ * search
+ */
+struct othello_bench_implementation_s {
+  const char *name;
+  unsigned long (*perft)(const othello_board_t *board, int side, int depth);
+};
+
+typedef struct othello_bench_implementation_s othello_bench_implementation_t;
+
+/**
+ * row and column steps of the 8 directions of the array implementation
+ */
+static const int othello_bench_directions[OTHELLO_BENCH_DIRECTIONS][2] = {
+    {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+
+/**
+ * every stroke of a side is generated at once, as the search does
+ */
+static unsigned long othello_bench_perft_moves(const othello_board_t *board,
+                                               int side, int depth,
+                                               bool passed) {
+  othello_board_t child;
+  othello_bitboard_t moves;
+  unsigned long leaves;
+  int square;
+
+  if (depth == 0) {
+    return 1;
+  }
+
+  if ((moves = othello_board_moves(board, side)) == 0) {
+    return passed ? 1
+                  : othello_bench_perft_moves(board, !side, depth - 1, true);
+  }
+
+  leaves = 0;
+  while (moves != 0) {
+    square = __builtin_ctzll(moves);
+    moves &= moves - 1;
+    child = *board;
+    othello_board_apply(&child, side, square,
+                        othello_board_flips(board, side, square));
+    leaves += othello_bench_perft_moves(&child, !side, depth - 1, false);
+  }
+
+  return leaves;
+}
+
+/**
+ *
+ */
+static unsigned long othello_bench_moves(const othello_board_t *board,
+                                         int side, int depth) {
+  return othello_bench_perft_moves(board, side, depth, false);
+}
+
+/**
+ * every square is checked then played one by one, as the server checks and
+ * plays a stroke (othello_game_is_stroke_valid, othello_game_play_stroke) and
+ * as the client does (othello_move_valid, othello_return_tokens)
+ */
+static unsigned long othello_bench_perft_squares(const othello_board_t *board,
+                                                 int side, int depth,
+                                                 bool passed) {
+  othello_board_t child;
+  unsigned long leaves;
+  int square;
+  bool played;
+
+  if (depth == 0) {
+    return 1;
+  }
+
+  leaves = 0;
+  played = false;
+  for (square = 0; square < OTHELLO_BENCH_SQUARES; square++) {
+    if (othello_bitboard_count(othello_board_flips(board, side, square)) ==
+        0) {
+      continue;
+    }
+    child = *board;
+    othello_board_play(&child, side, square);
+    leaves += othello_bench_perft_squares(&child, !side, depth - 1, false);
+    played = true;
+  }
+
+  if (!played) {
+    return passed ? 1
+                  : othello_bench_perft_squares(board, !side, depth - 1,
+                                                true);
+  }
+
+  return leaves;
+}
+
+/**
+ *
+ */
+static unsigned long othello_bench_squares(const othello_board_t *board,
+                                           int side, int depth) {
+  return othello_bench_perft_squares(board, side, depth, false);
+}
+
+/**
+ * discs walked along each direction on an array of squares, independent
+ * from the bitboards to check them
+ */
+static bool othello_bench_array_play(signed char *cells, int side, int x,
+                                     int y) {
+  int direction, step_x, step_y, i, j, count;
+  bool valid;
+
+  if (cells[OTHELLO_BOARD_SQUARE(x, y)] != OTHELLO_BENCH_EMPTY) {
+    return false;
+  }
+
+  valid = false;
+  for (direction = 0; direction < OTHELLO_BENCH_DIRECTIONS; direction++) {
+    step_x = othello_bench_directions[direction][0];
+    step_y = othello_bench_directions[direction][1];
+    count = 0;
+    for (i = x + step_x, j = y + step_y;
+         i >= 0 && i < OTHELLO_BOARD_LENGTH && j >= 0 &&
+         j < OTHELLO_BOARD_LENGTH &&
+         cells[OTHELLO_BOARD_SQUARE(i, j)] == !side;
+         i += step_x, j += step_y) {
+      count++;
+    }
+    if (count == 0 || i < 0 || i >= OTHELLO_BOARD_LENGTH || j < 0 ||
+        j >= OTHELLO_BOARD_LENGTH ||
+        cells[OTHELLO_BOARD_SQUARE(i, j)] != side) {
+      continue;
+    }
+    valid = true;
+    for (i = x + step_x, j = y + step_y; count > 0;
+         i += step_x, j += step_y, count--) {
+      cells[OTHELLO_BOARD_SQUARE(i, j)] = side;
+    }
+  }
+
+  if (valid) {
+    cells[OTHELLO_BOARD_SQUARE(x, y)] = side;
+  }
+
+  return valid;
+}
+
+/**
+ *
+ */
+static unsigned long othello_bench_perft_array(const signed char *cells,
+                                               int side, int depth,
+                                               bool passed) {
+  signed char child[OTHELLO_BENCH_SQUARES];
+  unsigned long leaves;
+  int x, y;
+  bool played;
+
+  if (depth == 0) {
+    return 1;
+  }
+
+  leaves = 0;
+  played = false;
+  for (x = 0; x < OTHELLO_BOARD_LENGTH; x++) {
+    for (y = 0; y < OTHELLO_BOARD_LENGTH; y++) {
+      memcpy(child, cells, sizeof(child));
+      if (othello_bench_array_play(child, side, x, y)) {
+        leaves += othello_bench_perft_array(child, !side, depth - 1, false);
+        played = true;
+      }
+    }
+  }
+
+  if (!played) {
+    return passed ? 1
+                  : othello_bench_perft_array(cells, !side, depth - 1, true);
+  }
+
+  return leaves;
+}
+
+/**
+ *
+ */
+static unsigned long othello_bench_array(const othello_board_t *board,
+                                         int side, int depth) {
+  signed char cells[OTHELLO_BENCH_SQUARES];
+  int square;
+
+  for (square = 0; square < OTHELLO_BENCH_SQUARES; square++) {
+    cells[square] = othello_board_owner(board, square);
+  }
+
+  return othello_bench_perft_array(cells, side, depth, false);
+}
+
+static const othello_bench_implementation_t othello_bench_implementations[] = {
+    {"moves", othello_bench_moves},
+    {"squares", othello_bench_squares},
+    {"array", othello_bench_array}};
+
+/**
+ * \return the side to play, -1 if a stroke is not valid
+ */
+static int othello_bench_setup(othello_board_t *board, const char *strokes) {
+  int side, x, y;
+
+  othello_board_init(board);
+  side = OTHELLO_BOARD_BLACK;
+
+  for (; strokes[0] != '\0' && strokes[1] != '\0'; strokes += 2) {
+    x = strokes[0] - 'A';
+    y = strokes[1] - '1';
+    if (othello_board_moves(board, side) == 0) {
+      side = !side;
+    }
+    if (othello_board_play(board, side, OTHELLO_BOARD_SQUARE(x, y)) !=
+        OTHELLO_SUCCESS) {
+      return -1;
+    }
+    side = !side;
+  }
+
+  return side;
+}
+
+/**
+ *
+ */
+static double othello_bench_seconds(const struct timespec *start,
+                                    const struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ *
+ */
+static void othello_bench_print_help(void) {
+  printf("Usage: othello-bench [-d | --depth <plies>]\n");
+  printf("  -d, --depth <plies>      plies removed from every perft, for a "
+         "quick check\n");
+}
+
+/**
+ *
+ */
+int main(int argc, char *argv[]) {
+  const othello_bench_position_t *position;
+  const othello_bench_implementation_t *implementation;
+  othello_board_t board;
+  struct timespec start, end;
+  unsigned long leaves, expected;
+  double seconds;
+  int side, depth, shallower, option, failures;
+  char *short_options = "hd:";
+  struct option long_options[] = {{"help", no_argument, NULL, 'h'},
+                                  {"depth", required_argument, NULL, 'd'},
+                                  {NULL, 0, NULL, 0}};
+
+  shallower = 0;
+
+  while ((option = getopt_long(argc, argv, short_options, long_options,
+                               NULL)) != -1) {
+    switch (option) {
+    case 'h':
+      othello_bench_print_help();
+      return EXIT_SUCCESS;
+    case 'd':
+      if (sscanf(optarg, "%d", &shallower) == 1 && shallower >= 0) {
+        break;
+      }
+      othello_bench_print_help();
+      return EXIT_FAILURE;
+    default:
+      othello_bench_print_help();
+      return EXIT_FAILURE;
+    }
+  }
+
+  printf("%-8s %5s %12s %-8s %9s %14s\n", "position", "depth", "leaves",
+         "perft", "seconds", "leaves per s");
+
+  failures = 0;
+  for (position = othello_bench_positions;
+       position < othello_bench_positions +
+                      sizeof(othello_bench_positions) /
+                          sizeof(othello_bench_position_t);
+       position++) {
+    if ((side = othello_bench_setup(&board, position->strokes)) < 0) {
+      printf("%-8s invalid strokes\n", position->name);
+      failures++;
+      continue;
+    }
+    depth = position->depth > shallower ? position->depth - shallower : 1;
+    /*the reference count is only known at the full depth*/
+    expected = depth == position->depth ? position->leaves : 0;
+
+    for (implementation = othello_bench_implementations;
+         implementation < othello_bench_implementations +
+                              sizeof(othello_bench_implementations) /
+                                  sizeof(othello_bench_implementation_t);
+         implementation++) {
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      leaves = implementation->perft(&board, side, depth);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      seconds = othello_bench_seconds(&start, &end);
+
+      if (expected == 0) {
+        expected = leaves;
+      }
+      printf("%-8s %5d %12lu %-8s %9.3f %14.0f %s\n", position->name, depth,
+             leaves, implementation->name, seconds,
+             seconds > 0 ? leaves / seconds : 0,
+             leaves == expected ? "ok" : "WRONG");
+      if (leaves != expected) {
+        failures++;
+      }
+    }
+  }
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,179 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#include "othello-board.h"
+
+#include <stdint.h>
+
+/*opponent discs a line can go through without wrapping to the next row*/
+#define OTHELLO_BOARD_INNER_COLUMNS UINT64_C(0x7e7e7e7e7e7e7e7e)
+#define OTHELLO_BOARD_ALL UINT64_C(0xffffffffffffffff)
+#define OTHELLO_BOARD_NOT_COLUMN_0 UINT64_C(0xfefefefefefefefe)
+#define OTHELLO_BOARD_NOT_COLUMN_7 UINT64_C(0x7f7f7f7f7f7f7f7f)
+#define OTHELLO_BOARD_AXES 4
+
+/**
+ * shift of a square index along each axis: row, column and both diagonals
+ */
+static const int othello_board_shifts[OTHELLO_BOARD_AXES] = {
+    1, OTHELLO_BOARD_LENGTH, OTHELLO_BOARD_LENGTH + 1,
+    OTHELLO_BOARD_LENGTH - 1};
+
+/**
+ * opponent discs a line can go through along each axis, lines along a row or a
+ * diagonal cannot go through the first and the last columns
+ */
+static const othello_bitboard_t othello_board_masks[OTHELLO_BOARD_AXES] = {
+    OTHELLO_BOARD_INNER_COLUMNS, OTHELLO_BOARD_ALL,
+    OTHELLO_BOARD_INNER_COLUMNS, OTHELLO_BOARD_INNER_COLUMNS};
+
+/**
+ *
+ */
+void othello_board_init(othello_board_t *board) {
+  board->discs[OTHELLO_BOARD_BLACK] =
+      OTHELLO_BOARD_BIT(OTHELLO_BOARD_SQUARE(3, 4)) |
+      OTHELLO_BOARD_BIT(OTHELLO_BOARD_SQUARE(4, 3));
+  board->discs[OTHELLO_BOARD_WHITE] =
+      OTHELLO_BOARD_BIT(OTHELLO_BOARD_SQUARE(3, 3)) |
+      OTHELLO_BOARD_BIT(OTHELLO_BOARD_SQUARE(4, 4));
+}
+
+/**
+ * a line can hold at most OTHELLO_BOARD_LENGTH - 2 opponent discs between the
+ * played square and the closing disc, the loops are unrolled by the compiler
+ */
+othello_bitboard_t othello_board_flips(const othello_board_t *board, int side,
+                                       int square) {
+  othello_bitboard_t own, opponent, bit, left, right, flips;
+  int axis, shift, i;
+
+  own = board->discs[side];
+  bit = OTHELLO_BOARD_BIT(square);
+  flips = 0;
+
+  if (square < 0 || square >= OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH ||
+      ((own | board->discs[!side]) & bit)) {
+    return flips;
+  }
+
+  for (axis = 0; axis < OTHELLO_BOARD_AXES; axis++) {
+    shift = othello_board_shifts[axis];
+    opponent = board->discs[!side] & othello_board_masks[axis];
+    left = (bit << shift) & opponent;
+    right = (bit >> shift) & opponent;
+    for (i = 1; i < OTHELLO_BOARD_LENGTH - 2; i++) {
+      left |= (left << shift) & opponent;
+      right |= (right >> shift) & opponent;
+    }
+    if ((left << shift) & own) {
+      flips |= left;
+    }
+    if ((right >> shift) & own) {
+      flips |= right;
+    }
+  }
+
+  return flips;
+}
+
+/**
+ * both directions of an axis are filled at once from every disc of side
+ */
+othello_bitboard_t othello_board_moves(const othello_board_t *board, int side) {
+  othello_bitboard_t own, opponent, left, right, moves;
+  int axis, shift, i;
+
+  own = board->discs[side];
+  moves = 0;
+
+  for (axis = 0; axis < OTHELLO_BOARD_AXES; axis++) {
+    shift = othello_board_shifts[axis];
+    opponent = board->discs[!side] & othello_board_masks[axis];
+    left = (own << shift) & opponent;
+    right = (own >> shift) & opponent;
+    for (i = 1; i < OTHELLO_BOARD_LENGTH - 2; i++) {
+      left |= (left << shift) & opponent;
+      right |= (right >> shift) & opponent;
+    }
+    moves |= (left << shift) | (right >> shift);
+  }
+
+  return moves & ~(own | board->discs[!side]);
+}
+
+/**
+ *
+ */
+othello_status_t othello_board_play(othello_board_t *board, int side,
+                                    int square) {
+  othello_bitboard_t flips;
+
+  if ((flips = othello_board_flips(board, side, square)) == 0) {
+    return OTHELLO_FAILURE;
+  }
+
+  othello_board_apply(board, side, square, flips);
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ *
+ */
+void othello_board_apply(othello_board_t *board, int side, int square,
+                         othello_bitboard_t flips) {
+  board->discs[side] |= flips | OTHELLO_BOARD_BIT(square);
+  board->discs[!side] &= ~flips;
+}
+
+/**
+ *
+ */
+int othello_board_score(const othello_board_t *board, int side) {
+  return othello_bitboard_count(board->discs[side]);
+}
+
+/**
+ *
+ */
+othello_bitboard_t othello_board_frontier(const othello_board_t *board,
+                                          int side) {
+  othello_bitboard_t discs, neighbours;
+
+  discs = board->discs[side];
+  neighbours = (discs << OTHELLO_BOARD_LENGTH) |
+               (discs >> OTHELLO_BOARD_LENGTH) |
+               (((discs << 1) | (discs << (OTHELLO_BOARD_LENGTH + 1)) |
+                 (discs >> (OTHELLO_BOARD_LENGTH - 1))) &
+                OTHELLO_BOARD_NOT_COLUMN_0) |
+               (((discs >> 1) | (discs >> (OTHELLO_BOARD_LENGTH + 1)) |
+                 (discs << (OTHELLO_BOARD_LENGTH - 1))) &
+                OTHELLO_BOARD_NOT_COLUMN_7);
+
+  return neighbours & ~(board->discs[OTHELLO_BOARD_BLACK] |
+                        board->discs[OTHELLO_BOARD_WHITE]);
+}
+
+/**
+ *
+ */
+int othello_board_owner(const othello_board_t *board, int square) {
+  int side;
+
+  for (side = 0; side < OTHELLO_BOARD_SIDES; side++) {
+    if (board->discs[side] & OTHELLO_BOARD_BIT(square)) {
+      return side;
+    }
+  }
+
+  return -1;
+}
+
+/**
+ *
+ */
+int othello_bitboard_count(othello_bitboard_t bitboard) {
+  return __builtin_popcountll(bitboard);
+}
@@ -0,0 +1,108 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_BOARD_H
+#define OTHELLO_BOARD_H
+
+#include "othello.h"
+
+#include <stdint.h>
+
+/**
+ * index of the square at row x and column y, bit of this square in a bitboard
+ */
+#define OTHELLO_BOARD_SQUARE(x, y) ((x)*OTHELLO_BOARD_LENGTH + (y))
+#define OTHELLO_BOARD_BIT(square) (UINT64_C(1) << (square))
+
+#define OTHELLO_BOARD_SIDES 2
+#define OTHELLO_BOARD_BLACK 0 /*first player, 'x' on the client*/
+#define OTHELLO_BOARD_WHITE 1 /*second player, 'o' on the client*/
+
+typedef uint64_t othello_bitboard_t;
+
+/**
+ * one 64-bit occupancy mask per side, bit OTHELLO_BOARD_SQUARE(x, y) is set if
+ * the side owns the disc at row x and column y
+ */
+struct othello_board_s {
+  othello_bitboard_t discs[OTHELLO_BOARD_SIDES];
+};
+
+typedef struct othello_board_s othello_board_t;
+
+/**
+ * set the board to the starting position
+ * \param board board to initialize
+ */
+void othello_board_init(othello_board_t *board);
+
+/**
+ * compute the discs flipped if side plays on square
+ * \param board current board
+ * \param side side to play
+ * \param square square to play
+ * \return the mask of flipped discs, 0 if the stroke is not valid
+ */
+othello_bitboard_t othello_board_flips(const othello_board_t *board, int side,
+                                       int square);
+
+/**
+ * compute every valid stroke of a side at once
+ * \param board current board
+ * \param side side to play
+ * \return the mask of squares where side can play
+ */
+othello_bitboard_t othello_board_moves(const othello_board_t *board, int side);
+
+/**
+ * play a stroke, place the disc and flip the captured ones
+ * \param board current board
+ * \param side side to play
+ * \param square square to play
+ * \return OTHELLO_SUCCESS if the stroke is valid
+ */
+othello_status_t othello_board_play(othello_board_t *board, int side,
+                                    int square);
+
+/**
+ * place a disc and flip discs previously computed by othello_board_flips
+ * \param board current board
+ * \param side side to play
+ * \param square square to play
+ * \param flips discs to flip
+ */
+void othello_board_apply(othello_board_t *board, int side, int square,
+                         othello_bitboard_t flips);
+
+/**
+ * count the discs of a side
+ * \param board current board
+ * \param side side to count
+ */
+int othello_board_score(const othello_board_t *board, int side);
+
+/**
+ * empty squares next to the discs of side, where the opponent may play later
+ * \param board current board
+ * \param side side of the discs
+ * \return the empty squares as a bitboard
+ */
+othello_bitboard_t othello_board_frontier(const othello_board_t *board,
+                                          int side);
+
+/**
+ * side owning the disc on square
+ * \param board current board
+ * \param square square to check
+ * \return the side or -1 if the square is empty
+ */
+int othello_board_owner(const othello_board_t *board, int square);
+
+/**
+ * count the bits set in a bitboard
+ * \param bitboard bitboard to count
+ */
+int othello_bitboard_count(othello_bitboard_t bitboard);
+
+#endif
@@ -0,0 +1,325 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-board.h"
+#include "othello-book.h"
+#include "othello-search.h"
+#include "othello-table.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OTHELLO_BOOK_BUILD_GAMES 100
+#define OTHELLO_BOOK_BUILD_PLIES 12
+#define OTHELLO_BOOK_BUILD_BUDGET 200 /*milliseconds per position*/
+#define OTHELLO_BOOK_BUILD_RANDOM 4   /*one stroke in 4 is random*/
+#define OTHELLO_BOOK_BUILD_TABLE 64   /*megabytes*/
+#define OTHELLO_BOOK_BUILD_LINE 1024
+
+/**
+ * positions searched so far, found again through an open addressing index
+ */
+struct othello_book_build_s {
+  othello_book_record_t *records;
+  size_t count;
+  size_t capacity;
+  size_t *slots; /*index of a record + 1, 0 if the slot is free*/
+  othello_search_t search;
+  othello_table_t table;
+  int plies; /*strokes of a game stored in the book*/
+};
+
+typedef struct othello_book_build_s othello_book_build_t;
+
+/**
+ * \return the slot of key, a free one if key is not indexed
+ */
+static size_t othello_book_build_slot(othello_book_build_t *build,
+                                      uint64_t key) {
+  size_t slot;
+
+  /*twice as many slots as records*/
+  slot = key & (build->capacity * 2 - 1);
+  while (build->slots[slot] != 0 &&
+         build->records[build->slots[slot] - 1].key != key) {
+    slot = (slot + 1) & (build->capacity * 2 - 1);
+  }
+
+  return slot;
+}
+
+/**
+ *
+ */
+static int othello_book_build_grow(othello_book_build_t *build) {
+  othello_book_record_t *records;
+  size_t i;
+
+  build->capacity = build->capacity == 0 ? 1024 : build->capacity * 2;
+  if ((records = realloc(build->records, build->capacity *
+                                             sizeof(othello_book_record_t))) ==
+      NULL) {
+    return -1;
+  }
+  build->records = records;
+
+  free(build->slots);
+  if ((build->slots = calloc(build->capacity * 2, sizeof(size_t))) == NULL) {
+    return -1;
+  }
+  for (i = 0; i < build->count; i++) {
+    build->slots[othello_book_build_slot(build, build->records[i].key)] =
+        i + 1;
+  }
+
+  return 0;
+}
+
+/**
+ * a position already in the book is only counted, a new one is searched
+ * \return the record of the position, NULL on failure
+ */
+static othello_book_record_t *
+othello_book_build_add(othello_book_build_t *build,
+                       const othello_board_t *board, int side) {
+  othello_book_record_t *record;
+  uint64_t key;
+  size_t slot;
+  int move;
+
+  key = othello_table_hash(board, side);
+  if (build->capacity != 0) {
+    slot = othello_book_build_slot(build, key);
+    if (build->slots[slot] != 0) {
+      record = build->records + build->slots[slot] - 1;
+      record->count++;
+      return record;
+    }
+  }
+
+  if ((move = othello_search_run(&(build->search), board, side)) < 0) {
+    return NULL;
+  }
+  if (build->count == build->capacity && othello_book_build_grow(build) < 0) {
+    return NULL;
+  }
+
+  record = build->records + build->count;
+  record->key = key;
+  record->score = build->search.score;
+  record->move = move;
+  record->depth = build->search.depth;
+  record->count = 1;
+  build->slots[othello_book_build_slot(build, key)] = ++(build->count);
+
+  return record;
+}
+
+/**
+ * the best stroke is played most of the time, a random one otherwise so the
+ * book holds the answers to other strokes as well
+ */
+static int othello_book_build_self_play(othello_book_build_t *build,
+                                        int games) {
+  othello_board_t board;
+  othello_book_record_t *record;
+  othello_bitboard_t moves;
+  int game, side, ply, passes, square, skip;
+
+  for (game = 0; game < games; game++) {
+    othello_board_init(&board);
+    side = OTHELLO_BOARD_BLACK;
+    passes = 0;
+    for (ply = 0; ply < build->plies && passes < 2;) {
+      if ((moves = othello_board_moves(&board, side)) == 0) {
+        passes++;
+        side = !side;
+        continue;
+      }
+      passes = 0;
+
+      if ((record = othello_book_build_add(build, &board, side)) == NULL) {
+        return -1;
+      }
+      square = record->move;
+      if (rand() % OTHELLO_BOOK_BUILD_RANDOM == 0) {
+        for (skip = rand() % othello_bitboard_count(moves); skip > 0;
+             skip--) {
+          moves &= moves - 1;
+        }
+        square = __builtin_ctzll(moves);
+      }
+
+      othello_board_play(&board, side, square);
+      side = !side;
+      ply++;
+    }
+    fprintf(stderr, "game %d/%d, %lu positions\n", game + 1, games,
+            (unsigned long)build->count);
+  }
+
+  return 0;
+}
+
+/**
+ * one game per line, strokes written as on the client ("C4" is row C, column
+ * 4), passes are implied
+ */
+static int othello_book_build_game_records(othello_book_build_t *build,
+                                           const char *path) {
+  othello_board_t board;
+  char line[OTHELLO_BOOK_BUILD_LINE];
+  char *cursor;
+  FILE *file;
+  int number, side, ply, x, y;
+
+  if ((file = fopen(path, "r")) == NULL) {
+    return -1;
+  }
+
+  for (number = 1; fgets(line, sizeof(line), file) != NULL; number++) {
+    othello_board_init(&board);
+    side = OTHELLO_BOARD_BLACK;
+    for (cursor = line, ply = 0; *cursor != '\0' && ply < build->plies;
+         cursor++) {
+      x = *cursor - (*cursor >= 'a' ? 'a' : 'A');
+      y = cursor[1] - '1';
+      if (x < 0 || x >= OTHELLO_BOARD_LENGTH || y < 0 ||
+          y >= OTHELLO_BOARD_LENGTH) {
+        continue;
+      }
+      cursor++;
+
+      if (othello_board_moves(&board, side) == 0) {
+        side = !side;
+      }
+      if (othello_board_flips(&board, side, OTHELLO_BOARD_SQUARE(x, y)) ==
+          0) {
+        fprintf(stderr, "%s:%d: illegal stroke %c%c, rest of the game "
+                        "skipped\n",
+                path, number, cursor[-1], cursor[0]);
+        break;
+      }
+      if (othello_book_build_add(build, &board, side) == NULL) {
+        fclose(file);
+        return -1;
+      }
+
+      othello_board_play(&board, side, OTHELLO_BOARD_SQUARE(x, y));
+      side = !side;
+      ply++;
+    }
+  }
+  fclose(file);
+
+  return 0;
+}
+
+/**
+ *
+ */
+static void othello_book_build_print_help(void) {
+  printf("Usage: othello-book-build [options]\n");
+  printf("  -o, --output <path>      book file to write (default: %s)\n",
+         OTHELLO_BOOK_DEFAULT_PATH);
+  printf("  -g, --games <count>      games of self-play (default: %d)\n",
+         OTHELLO_BOOK_BUILD_GAMES);
+  printf("  -r, --records <path>     game records, one game per line\n");
+  printf("  -p, --plies <count>      strokes of a game stored (default: %d)\n",
+         OTHELLO_BOOK_BUILD_PLIES);
+  printf("  -t, --time <ms>          search time per position (default: "
+         "%d)\n",
+         OTHELLO_BOOK_BUILD_BUDGET);
+  printf("  -j, --threads <count>    search threads (default: 1)\n");
+  printf("  -s, --seed <number>      seed of the random strokes\n");
+}
+
+/**
+ *
+ */
+int main(int argc, char *argv[]) {
+  othello_book_build_t build;
+  char *output, *records;
+  int games, option;
+  char *short_options = "ho:g:r:p:t:j:s:";
+  struct option long_options[] = {{"help", no_argument, NULL, 'h'},
+                                  {"output", required_argument, NULL, 'o'},
+                                  {"games", required_argument, NULL, 'g'},
+                                  {"records", required_argument, NULL, 'r'},
+                                  {"plies", required_argument, NULL, 'p'},
+                                  {"time", required_argument, NULL, 't'},
+                                  {"threads", required_argument, NULL, 'j'},
+                                  {"seed", required_argument, NULL, 's'},
+                                  {NULL, 0, NULL, 0}};
+
+  memset(&build, 0, sizeof(build));
+  othello_search_init(&(build.search), OTHELLO_BOOK_BUILD_BUDGET);
+  build.plies = OTHELLO_BOOK_BUILD_PLIES;
+  output = OTHELLO_BOOK_DEFAULT_PATH;
+  records = NULL;
+  games = OTHELLO_BOOK_BUILD_GAMES;
+
+  while ((option = getopt_long(argc, argv, short_options, long_options,
+                               NULL)) != -1) {
+    switch (option) {
+    case 'h':
+      othello_book_build_print_help();
+      return EXIT_SUCCESS;
+    case 'o':
+      output = optarg;
+      break;
+    case 'g':
+      games = atoi(optarg);
+      break;
+    case 'r':
+      records = optarg;
+      break;
+    case 'p':
+      build.plies = atoi(optarg);
+      break;
+    case 't':
+      build.search.budget = atol(optarg);
+      break;
+    case 'j':
+      build.search.threads = atoi(optarg);
+      break;
+    case 's':
+      srand(atoi(optarg));
+      break;
+    default:
+      othello_book_build_print_help();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (othello_table_init(&(build.table), OTHELLO_BOOK_BUILD_TABLE) < 0) {
+    perror("othello_table_init");
+    return EXIT_FAILURE;
+  }
+  build.search.table = &(build.table);
+
+  if (records != NULL &&
+      othello_book_build_game_records(&build, records) < 0) {
+    perror(records);
+    return EXIT_FAILURE;
+  }
+  if (othello_book_build_self_play(&build, games) < 0) {
+    perror("othello_book_build_self_play");
+    return EXIT_FAILURE;
+  }
+
+  if (othello_book_write(output, build.records, build.count) < 0) {
+    perror(output);
+    return EXIT_FAILURE;
+  }
+  printf("%lu positions written to %s\n", (unsigned long)build.count,
+         output);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-book.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define OTHELLO_BOOK_BINARY_RANGE 16 /*records left for binary search*/
+#define OTHELLO_BOOK_INTERPOLATIONS 8 /*guesses before binary search*/
+
+/**
+ *
+ */
+int othello_book_open(othello_book_t *book, const char *path) {
+  const othello_book_header_t *header;
+  struct stat stat_buf;
+  int fd;
+
+  memset(book, 0, sizeof(othello_book_t));
+
+  if ((fd = open(path, O_RDONLY)) < 0) {
+    return -1;
+  }
+  if (fstat(fd, &stat_buf) < 0 ||
+      (size_t)stat_buf.st_size < sizeof(othello_book_header_t)) {
+    close(fd);
+    return -1;
+  }
+
+  book->length = stat_buf.st_size;
+  if ((book->mapping = mmap(NULL, book->length, PROT_READ, MAP_SHARED, fd,
+                            0)) == MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+  close(fd);
+
+  header = (const othello_book_header_t *)book->mapping;
+  if (memcmp(header->magic, OTHELLO_BOOK_MAGIC, sizeof(OTHELLO_BOOK_MAGIC)) ||
+      header->version != OTHELLO_BOOK_VERSION ||
+      sizeof(othello_book_header_t) +
+              (size_t)header->count * sizeof(othello_book_record_t) >
+          book->length) {
+    munmap(book->mapping, book->length);
+    memset(book, 0, sizeof(othello_book_t));
+    return -1;
+  }
+
+  book->records = (const othello_book_record_t *)(header + 1);
+  book->count = header->count;
+  /*a lookup touches a few pages far from each other*/
+  madvise(book->mapping, book->length, MADV_RANDOM);
+
+  return 0;
+}
+
+/**
+ *
+ */
+void othello_book_close(othello_book_t *book) {
+  if (book->mapping != NULL) {
+    munmap(book->mapping, book->length);
+  }
+  memset(book, 0, sizeof(othello_book_t));
+}
+
+/**
+ * the keys are hashes, so the position of a key in the range is guessed from
+ * its value, a bad guess only costs one more step
+ */
+const othello_book_record_t *othello_book_find(const othello_book_t *book,
+                                               uint64_t key) {
+  size_t low, high, middle;
+  uint64_t low_key, high_key;
+  int guesses;
+
+  if (book->count == 0) {
+    return NULL;
+  }
+
+  low = 0;
+  high = book->count - 1;
+  guesses = 0;
+  while (low <= high) {
+    low_key = book->records[low].key;
+    high_key = book->records[high].key;
+    if (key < low_key || key > high_key) {
+      return NULL;
+    }
+
+    if (high - low < OTHELLO_BOOK_BINARY_RANGE ||
+        guesses >= OTHELLO_BOOK_INTERPOLATIONS) {
+      middle = low + (high - low) / 2;
+    } else {
+      middle = low + (size_t)((double)(key - low_key) /
+                              (double)(high_key - low_key) * (high - low));
+      guesses++;
+    }
+
+    if (book->records[middle].key == key) {
+      return book->records + middle;
+    }
+    if (book->records[middle].key < key) {
+      low = middle + 1;
+    } else {
+      if (middle == 0) {
+        return NULL;
+      }
+      high = middle - 1;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ *
+ */
+static int othello_book_compare(const void *a, const void *b) {
+  uint64_t key_a, key_b;
+
+  key_a = ((const othello_book_record_t *)a)->key;
+  key_b = ((const othello_book_record_t *)b)->key;
+
+  return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+/**
+ * the book is written next to the file and renamed over it, a process mapping
+ * the previous book keeps reading it
+ */
+int othello_book_write(const char *path, othello_book_record_t *records,
+                       size_t count) {
+  othello_book_header_t header;
+  char temporary[4096];
+  FILE *file;
+
+  qsort(records, count, sizeof(othello_book_record_t), othello_book_compare);
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, OTHELLO_BOOK_MAGIC, sizeof(OTHELLO_BOOK_MAGIC));
+  header.version = OTHELLO_BOOK_VERSION;
+  header.count = count;
+
+  snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+  if ((file = fopen(temporary, "wb")) == NULL) {
+    return -1;
+  }
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      fwrite(records, sizeof(othello_book_record_t), count, file) != count) {
+    fclose(file);
+    unlink(temporary);
+    return -1;
+  }
+  if (fclose(file) != 0 || rename(temporary, path) < 0) {
+    unlink(temporary);
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_BOOK_H
+#define OTHELLO_BOOK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define OTHELLO_BOOK_DEFAULT_PATH "othello.book"
+#define OTHELLO_BOOK_MAGIC "OTHBOOK"
+#define OTHELLO_BOOK_VERSION 1
+
+/**
+ * beginning of a book file in host byte order, followed by the records sorted
+ * by key
+ */
+struct othello_book_header_s {
+  char magic[8]; /*OTHELLO_BOOK_MAGIC*/
+  uint32_t version;
+  uint32_t count; /*count of records*/
+};
+
+typedef struct othello_book_header_s othello_book_header_t;
+
+/**
+ * best stroke of a position, the key is the Zobrist hash of
+ * othello_table_hash so a book only matches the keys of the same build
+ */
+struct othello_book_record_s {
+  uint64_t key;
+  int16_t score; /*score of the search for the side to play*/
+  uint8_t move;  /*square of the stroke (x * 8 + y)*/
+  uint8_t depth; /*depth of the search, the count of empties if solved*/
+  uint32_t count; /*times the position was reached while building*/
+};
+
+typedef struct othello_book_record_s othello_book_record_t;
+
+/**
+ * read-only mapping of a book file, shared by every process through the page
+ * cache
+ */
+struct othello_book_s {
+  void *mapping;
+  size_t length;
+  const othello_book_record_t *records;
+  size_t count;
+};
+
+typedef struct othello_book_s othello_book_t;
+
+/**
+ * map a book file
+ * \param book book to initialize
+ * \param path path of the file
+ * \return a negative value if the file cannot be mapped or is not a book
+ */
+int othello_book_open(othello_book_t *book, const char *path);
+
+/**
+ * unmap a book file
+ * \param book current book
+ */
+void othello_book_close(othello_book_t *book);
+
+/**
+ * find a position by interpolation search, the keys being uniformly
+ * distributed, with binary search steps once the range is small
+ * \param book current book
+ * \param key hash of the position
+ * \return the record or NULL if the position is not in the book
+ */
+const othello_book_record_t *othello_book_find(const othello_book_t *book,
+                                               uint64_t key);
+
+/**
+ * sort records by key and write them as a book file
+ * \param path path of the file
+ * \param records records to write, sorted in place
+ * \param count count of records, the keys must be unique
+ * \return a negative value on failure
+ */
+int othello_book_write(const char *path, othello_book_record_t *records,
+                       size_t count);
+
+#endif
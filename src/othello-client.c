@@ -6,7 +6,11 @@ client <adresse-serveur> <message-a-transmettre>
 #define _GNU_SOURCE
 
 #include "othello.h"
+#include "othello-board.h"
+#include "othello-book.h"
 #include "othello-client.h"
+#include "othello-search.h"
+#include "othello-table.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -22,38 +26,49 @@ client <adresse-serveur> <message-a-transmettre>
 
 #define OTHELLO_DEFAULT_SERVER_ADRESS "localhost"
 #define OTHELLO_DEFAULT_PORT 5000
+#define OTHELLO_CLIENT_MAX_THREADS 256
 
 othello_client_enum_t client_state;
-char othello_board[OTHELLO_BOARD_LENGTH][OTHELLO_BOARD_LENGTH];
+othello_board_t othello_board;
+const char othello_colors[OTHELLO_BOARD_SIDES] = {'x', 'o'};
 char my_color;
 char opponent_color;
 unsigned char xMove;
 unsigned char yMove;
 int server_port = OTHELLO_DEFAULT_PORT;
 bool auto_mode; /* indicate if yes or not the AI plays insted of you */
+bool list_continued; /* indicate if the next rooms list page follows the
+                        previous one */
+bool lobby_subscribed; /* indicate if yes or not the lobby events are shown */
+othello_search_t othello_search; /* AI search, keeps its history between
+                                   moves */
+othello_table_t othello_table; /* positions already searched by the AI */
+size_t othello_table_size;     /* size of othello_table in MB, 0 if none */
+othello_book_t othello_book;   /* opening book of the AI, empty if none */
+/* held during a search of the AI, the table and the book are not changed */
+pthread_mutex_t othello_search_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /************************************/
 /********* TABLE FUNCTIONS **********/
 /************************************/
 
 void othello_init_board() {
-  int i, j;
   auto_mode = false;
-  for (i = 0; i < OTHELLO_BOARD_LENGTH; ++i) {
-    for (j = 0; j < OTHELLO_BOARD_LENGTH; ++j) {
-      othello_board[i][j] = '*'; /* '*' is used as empty cell */
-    }
-  }
+  othello_search_init(&othello_search, OTHELLO_SEARCH_DEFAULT_BUDGET);
+  othello_table_size = 0;
+  if (othello_table_init(&othello_table, OTHELLO_TABLE_DEFAULT_SIZE) == 0) {
+    othello_table_size = OTHELLO_TABLE_DEFAULT_SIZE;
+    othello_search.table = &othello_table;
+  }
+  /* the book is optional, the AI searches every position without it */
+  if (othello_book_open(&othello_book, OTHELLO_BOOK_DEFAULT_PATH) == 0)
+    othello_search.book = &othello_book;
   /* see othello tules for this setup */
-  othello_board[OTHELLO_BOARD_LENGTH / 2 - 1][OTHELLO_BOARD_LENGTH / 2 - 1] =
-      'o';
-  othello_board[OTHELLO_BOARD_LENGTH / 2 - 1][OTHELLO_BOARD_LENGTH / 2] = 'x';
-  othello_board[OTHELLO_BOARD_LENGTH / 2][OTHELLO_BOARD_LENGTH / 2 - 1] = 'x';
-  othello_board[OTHELLO_BOARD_LENGTH / 2][OTHELLO_BOARD_LENGTH / 2] = 'o';
+  othello_board_init(&othello_board);
 }
 
 void othello_display_board() {
-  int i, j;
+  int i, j, side;
 
   printf("\n   ");
   for (i = 0; i < OTHELLO_BOARD_LENGTH; ++i) {
@@ -66,7 +81,9 @@ void othello_display_board() {
   for (i = 0; i < OTHELLO_BOARD_LENGTH; ++i) {
     printf("\n%c| ", (char)(i + 65));
     for (j = 0; j < OTHELLO_BOARD_LENGTH; ++j) {
-      printf("%c ", othello_board[i][j]);
+      side = othello_board_owner(&othello_board, OTHELLO_BOARD_SQUARE(i, j));
+      /* '*' is used as empty cell */
+      printf("%c ", (side < 0) ? '*' : othello_colors[side]);
     }
   }
   printf("\n\n");
@@ -86,8 +103,12 @@ bool othello_is_number(char *str) {
   return true;
 }
 
+int othello_color_side(char color) {
+  return (color == othello_colors[OTHELLO_BOARD_BLACK]) ? OTHELLO_BOARD_BLACK
+                                                        : OTHELLO_BOARD_WHITE;
+}
+
 void othello_place_token(int socket_descriptor, char color) {
-  othello_board[xMove][yMove] = color;
   othello_return_tokens(xMove, yMove, color);
   printf("New token added to the board in : (%c : %d)\n", (char)(xMove + 65),
          yMove);
@@ -95,308 +116,158 @@ void othello_place_token(int socket_descriptor, char color) {
 }
 
 void othello_return_tokens(int x, int y, char color) {
-  int x_iter, y_iter;
-
-  /* for each sides */
-  /* as long as the next token is the opposite color, move on it */
-  /* when it's not, if it's my color, do the same parkour in the opposite
-   * direction and change the color of each passed tokens */
-
-  /* check top side */
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && othello_board[x_iter - 1][y_iter] != color &&
-         othello_board[x_iter - 1][y_iter] != '*') {
-    --x_iter;
-  }
-  if ((x_iter - 1 >= 0)) {
-    if (othello_board[x_iter - 1][y_iter] == color) {
-      while (x_iter < x) {
-        othello_board[x_iter][y_iter] = color;
-        ++x_iter;
-      }
-    }
-  }
-  /* check right side */
-  x_iter = x;
-  y_iter = y;
-  while ((y_iter + 1 <= 7) && othello_board[x_iter][y_iter + 1] != color &&
-         othello_board[x_iter][y_iter + 1] != '*') {
-    ++y_iter;
-  }
-  if ((y_iter + 1 <= 7)) {
-    if (othello_board[x_iter][y_iter + 1] == color) {
-      while (y_iter > y) {
-        othello_board[x_iter][y_iter] = color;
-        --y_iter;
-      }
-    }
-  }
-  /* check bottom side */
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && othello_board[x_iter + 1][y_iter] != color &&
-         othello_board[x_iter + 1][y_iter] != '*') {
-    ++x_iter;
-  }
-  if ((x_iter + 1 <= 7)) {
-    if (othello_board[x_iter + 1][y_iter] == color) {
-      while (x_iter > x) {
-        othello_board[x_iter][y_iter] = color;
-        --x_iter;
-      }
-    }
-  }
-  /* check left side */
-  x_iter = x;
-  y_iter = y;
-  while ((y_iter - 1 >= 0) && othello_board[x_iter][y_iter - 1] != color &&
-         othello_board[x_iter][y_iter - 1] != '*') {
-    --y_iter;
-  }
-  if ((y_iter - 1 >= 0)) {
-    if (othello_board[x_iter][y_iter - 1] == color) {
-      while (y_iter < y) {
-        othello_board[x_iter][y_iter] = color;
-        ++y_iter;
-      }
-    }
-  }
-  /* check top right side */
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && (y_iter + 1 <= 7) &&
-         othello_board[x_iter - 1][y_iter + 1] != color &&
-         othello_board[x_iter - 1][y_iter + 1] != '*') {
-    --x_iter;
-    ++y_iter;
-  }
-  if ((x_iter - 1 >= 0) && (y_iter + 1 <= 7)) {
-    if (othello_board[x_iter - 1][y_iter + 1] == color) {
-      while (x_iter < x) {
-        othello_board[x_iter][y_iter] = color;
-        ++x_iter;
-        --y_iter;
-      }
-    }
-  }
-  /* check bottom right side */
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && (y_iter + 1 <= 7) &&
-         othello_board[x_iter + 1][y_iter + 1] != color &&
-         othello_board[x_iter + 1][y_iter + 1] != '*') {
-    ++x_iter;
-    ++y_iter;
-  }
-  if ((x_iter + 1 <= 7) && (y_iter + 1 <= 7)) {
-    if (othello_board[x_iter + 1][y_iter + 1] == color) {
-      while (x_iter > x) {
-        othello_board[x_iter][y_iter] = color;
-        --x_iter;
-        --y_iter;
-      }
-    }
-  }
-  /* check bottom left side */
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && (y_iter - 1 >= 0) &&
-         othello_board[x_iter + 1][y_iter - 1] != color &&
-         othello_board[x_iter + 1][y_iter - 1] != '*') {
-    ++x_iter;
-    --y_iter;
-  }
-  if ((x_iter + 1 <= 7) && (y_iter - 1 >= 0)) {
-    if (othello_board[x_iter + 1][y_iter - 1] == color) {
-      while (x_iter > x) {
-        othello_board[x_iter][y_iter] = color;
-        --x_iter;
-        ++y_iter;
-      }
-    }
-  }
-  /* check top left side */
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && (y_iter - 1 >= 0) &&
-         othello_board[x_iter - 1][y_iter - 1] != color &&
-         othello_board[x_iter - 1][y_iter - 1] != '*') {
-    --x_iter;
-    --y_iter;
-  }
-  if ((x_iter - 1 >= 0) && (y_iter - 1 >= 0)) {
-    if (othello_board[x_iter - 1][y_iter - 1] == color) {
-      while (x_iter < x) {
-        othello_board[x_iter][y_iter] = color;
-        ++x_iter;
-        ++y_iter;
-      }
-    }
-  }
+  /* place the token then flip every line of opposite tokens it closes */
+  othello_board_play(&othello_board, othello_color_side(color),
+                     OTHELLO_BOARD_SQUARE(x, y));
 }
 
 int othello_move_valid(int x, int y, char color) {
-  /* same than return token but return true if at least one token is returnable
-   */
-
-  int x_iter, y_iter, nb_returned, final_returned;
-
-  if (othello_board[x][y] != '*')
-    return 0;
-
-  nb_returned = 0;
-  final_returned = 0;
-
-  x_iter = x; /* 6 */
-  y_iter = y; /* 7 */
-  while ((x_iter - 1 >= 0) && othello_board[x_iter - 1][y_iter] != color &&
-         othello_board[x_iter - 1][y_iter] != '*') {
-    --x_iter;
-    ++nb_returned;
-  }
-  if ((x_iter - 1 >= 0)) {
-    if (othello_board[x_iter - 1][y_iter] == color) {
-      final_returned += nb_returned;
-    }
-  }
+  /* number of tokens the move would return, 0 if the move is not valid */
+  return othello_bitboard_count(othello_board_flips(
+      &othello_board, othello_color_side(color), OTHELLO_BOARD_SQUARE(x, y)));
+}
 
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((y_iter + 1 <= 7) && othello_board[x_iter][y_iter + 1] != color &&
-         othello_board[x_iter][y_iter + 1] != '*') {
-    ++y_iter;
-    ++nb_returned;
-  }
-  if ((y_iter + 1 <= 7)) {
-    if (othello_board[x_iter][y_iter + 1] == color) {
-      final_returned += nb_returned;
+void othello_display_moves() {
+  int i, j = 0;
+  othello_bitboard_t moves;
+  moves = othello_board_moves(&othello_board, othello_color_side(my_color));
+  printf("Possible moves : \n");
+  for (i = 0; i < OTHELLO_BOARD_LENGTH; ++i) {
+    for (j = 0; j < OTHELLO_BOARD_LENGTH; ++j) {
+      if (moves & OTHELLO_BOARD_BIT(OTHELLO_BOARD_SQUARE(i, j))) {
+        printf("(%c;%d) ", (char)(i + 65), j + 1);
+      }
     }
   }
+  printf("\n");
+}
 
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && othello_board[x_iter + 1][y_iter] != color &&
-         othello_board[x_iter + 1][y_iter] != '*') {
-    ++x_iter;
-    ++nb_returned;
-  }
-  if ((x_iter + 1 <= 7)) {
-    if (othello_board[x_iter + 1][y_iter] == color) {
-      final_returned += nb_returned;
-    }
-  }
+void othello_calc_best_move(int *x_pos, int *y_pos) {
+  int square;
+  /* iterative deepening alpha-beta search within the time budget */
+  pthread_mutex_lock(&othello_search_mutex);
+  square = othello_search_run(&othello_search, &othello_board,
+                              othello_color_side(my_color));
+  if (square >= 0) {
+    *x_pos = square / OTHELLO_BOARD_LENGTH;
+    *y_pos = square % OTHELLO_BOARD_LENGTH;
+  }
+  if (othello_search.booked)
+    printf("\nbook move, score %d\n", othello_search.score);
+  else if (othello_search.solved)
+    printf("\nendgame solved, %lu nodes, final margin %+d\n",
+           othello_search.nodes, othello_search.score);
+  else
+    printf("\nsearch depth %d, %lu nodes, score %d\n", othello_search.depth,
+           othello_search.nodes, othello_search.score);
+  pthread_mutex_unlock(&othello_search_mutex);
+}
 
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((y_iter - 1 >= 0) && othello_board[x_iter][y_iter - 1] != color &&
-         othello_board[x_iter][y_iter - 1] != '*') {
-    --y_iter;
-    ++nb_returned;
-  }
-  if ((y_iter - 1 >= 0)) {
-    if (othello_board[x_iter][y_iter - 1] == color) {
-      final_returned += nb_returned;
+void othello_set_auto(int socket_descriptor, char *usr_inpt,
+                      size_t inpt_len) {
+  char budget[16];
+  /* "/auto ms" sets the time budget per move and turns the AI on */
+  if (usr_inpt != NULL && inpt_len > 1 && inpt_len - 1 < sizeof(budget)) {
+    memcpy(budget, usr_inpt + 1, inpt_len - 1);
+    budget[inpt_len - 1] = '\0';
+    if (!othello_is_number(budget) || atol(budget) <= 0) {
+      printf("Wrong time budget!\n");
+      return;
     }
+    othello_search.budget = atol(budget);
+    auto_mode = true;
+  } else {
+    auto_mode = !auto_mode;
   }
+  printf("AI %s, %ld ms per move\n", auto_mode ? "on" : "off",
+         othello_search.budget);
+  if (auto_mode && client_state == OTHELLO_CLIENT_STATE_PLAYING)
+    othello_send_auto_move(socket_descriptor);
+}
 
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && (y_iter + 1 <= 7) &&
-         othello_board[x_iter - 1][y_iter + 1] != color &&
-         othello_board[x_iter - 1][y_iter + 1] != '*') {
-    --x_iter;
-    ++y_iter;
-    ++nb_returned;
-  }
-  if ((x_iter - 1 >= 0) && (y_iter + 1 <= 7)) {
-    if (othello_board[x_iter - 1][y_iter + 1] == color) {
-      final_returned += nb_returned;
+void othello_set_hash(char *usr_inpt, size_t inpt_len) {
+  char size[16];
+  /* "/hash MB" replaces the transposition table, "/hash 0" removes it */
+  if (usr_inpt != NULL && inpt_len > 1 && inpt_len - 1 < sizeof(size)) {
+    memcpy(size, usr_inpt + 1, inpt_len - 1);
+    size[inpt_len - 1] = '\0';
+    if (!othello_is_number(size)) {
+      printf("Wrong table size!\n");
+      return;
     }
-  }
-
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && (y_iter + 1 <= 7) &&
-         othello_board[x_iter + 1][y_iter + 1] != color &&
-         othello_board[x_iter + 1][y_iter + 1] != '*') {
-    ++x_iter;
-    ++y_iter;
-    ++nb_returned;
-  }
-  if ((x_iter + 1 <= 7) && (y_iter + 1 <= 7)) {
-    if (othello_board[x_iter + 1][y_iter + 1] == color) {
-      final_returned += nb_returned;
+    /* the table is replaced once the search of the read thread is over */
+    pthread_mutex_lock(&othello_search_mutex);
+    if (othello_search.table != NULL) {
+      othello_table_free(&othello_table);
+      othello_search.table = NULL;
     }
-  }
-
-  nb_returned = 0;
-  x_iter = x; /* 3 */
-  y_iter = y; /* 7 */
-  while ((x_iter + 1 <= 7) && (y_iter - 1 >= 0) &&
-         othello_board[x_iter + 1][y_iter - 1] != color &&
-         othello_board[x_iter + 1][y_iter - 1] != '*') {
-    ++x_iter;
-    --y_iter;
-    ++nb_returned;
-  }
-  if ((x_iter + 1 <= 7) && (y_iter - 1 >= 0)) {
-    if (othello_board[x_iter + 1][y_iter - 1] == color) {
-      final_returned += nb_returned;
+    othello_table_size = 0;
+    if (atol(size) > 0) {
+      if (othello_table_init(&othello_table, atol(size)) < 0) {
+        printf("Impossible to allocate the table!\n");
+      } else {
+        othello_table_size = atol(size);
+        othello_search.table = &othello_table;
+      }
     }
+    pthread_mutex_unlock(&othello_search_mutex);
   }
+  printf("AI table of %lu MB\n", (unsigned long)othello_table_size);
+}
 
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && (y_iter - 1 >= 0) &&
-         othello_board[x_iter - 1][y_iter - 1] != color &&
-         othello_board[x_iter - 1][y_iter - 1] != '*') {
-    --x_iter;
-    --y_iter;
-    ++nb_returned;
-  }
-  if ((x_iter - 1 >= 0) && (y_iter - 1 >= 0)) {
-    if (othello_board[x_iter - 1][y_iter - 1] == color) {
-      final_returned += nb_returned;
+void othello_set_endgame(char *usr_inpt, size_t inpt_len) {
+  char empties[16];
+  /* "/endgame n" solves the game exactly from n empty squares, 0 never */
+  if (usr_inpt != NULL && inpt_len > 1 && inpt_len - 1 < sizeof(empties)) {
+    memcpy(empties, usr_inpt + 1, inpt_len - 1);
+    empties[inpt_len - 1] = '\0';
+    if (!othello_is_number(empties) ||
+        atoi(empties) > OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH) {
+      printf("Wrong count of empty squares!\n");
+      return;
     }
+    othello_search.endgame = atoi(empties);
   }
-  return final_returned;
+  printf("AI solves the game from %d empty squares, in half of its time\n",
+         othello_search.endgame);
 }
 
-void othello_display_moves() {
-  int i, j = 0;
-  printf("Possible moves : \n");
-  for (i = 0; i < OTHELLO_BOARD_LENGTH; ++i) {
-    for (j = 0; j < OTHELLO_BOARD_LENGTH; ++j) {
-      if (othello_move_valid(i, j, my_color) > 0) {
-        printf("(%c;%d) ", (char)(i + 65), j + 1);
-      }
+void othello_set_threads(char *usr_inpt, size_t inpt_len) {
+  char threads[16];
+  /* "/threads n" lets n threads search together, they share the table */
+  if (usr_inpt != NULL && inpt_len > 1 && inpt_len - 1 < sizeof(threads)) {
+    memcpy(threads, usr_inpt + 1, inpt_len - 1);
+    threads[inpt_len - 1] = '\0';
+    if (!othello_is_number(threads) || atoi(threads) < 1 ||
+        atoi(threads) > OTHELLO_CLIENT_MAX_THREADS) {
+      printf("Wrong count of threads!\n");
+      return;
     }
+    othello_search.threads = atoi(threads);
   }
-  printf("\n");
+  printf("AI searches with %d threads%s\n", othello_search.threads,
+         (othello_search.threads > 1 && othello_search.table == NULL)
+             ? " (only one without a table)"
+             : "");
 }
 
-void othello_calc_best_move(int *x_pos, int *y_pos) {
-  int i, j;
-  int returned = 0;
-  int max_returned = 0;
-  for (i = 0; i < OTHELLO_BOARD_LENGTH; ++i) {
-    for (j = 0; j < OTHELLO_BOARD_LENGTH; ++j) {
-      if ((returned = othello_move_valid(i, j, my_color)) > 0) {
-        if (returned > max_returned) {
-          *x_pos = i;
-          *y_pos = j;
-        }
-      }
-    }
-  }
-  printf("\n");
+void othello_set_book(char *usr_inpt, size_t inpt_len) {
+  char path[256];
+  /* "/book path" maps another book file, a wrong file leaves no book */
+  if (usr_inpt != NULL && inpt_len > 1 && inpt_len - 1 < sizeof(path)) {
+    memcpy(path, usr_inpt + 1, inpt_len - 1);
+    path[inpt_len - 1] = '\0';
+    /* the book is unmapped once the search of the read thread is over */
+    pthread_mutex_lock(&othello_search_mutex);
+    othello_search.book = NULL;
+    othello_book_close(&othello_book);
+    if (othello_book_open(&othello_book, path) < 0)
+      printf("Impossible to open the book!\n");
+    else
+      othello_search.book = &othello_book;
+    pthread_mutex_unlock(&othello_search_mutex);
+  }
+  printf("AI book of %lu positions\n", (unsigned long)othello_book.count);
 }
 
 /************************************/
@@ -451,6 +322,16 @@ othello_client_enum_t othello_read_user_input(char **usr_input,
           input_len = 0;
           return OTHELLO_CLIENT_INPUT_AUTO;
         }
+        if (strncmp(stdin_value, "/hash", 5) == 0) {
+          free(stdin_value);
+          input_len = 0;
+          return OTHELLO_CLIENT_INPUT_HASH;
+        }
+        if (strncmp(stdin_value, "/book", 5) == 0) {
+          free(stdin_value);
+          input_len = 0;
+          return OTHELLO_CLIENT_INPUT_BOOK;
+        }
         if (strncmp(stdin_value, "/help", 5) == 0) {
           free(stdin_value);
           input_len = 0;
@@ -465,6 +346,16 @@ othello_client_enum_t othello_read_user_input(char **usr_input,
             free(stdin_value);
             return OTHELLO_CLIENT_INPUT_CONNECT_DEFAULT;
           }
+          if (strncmp(stdin_value, "/endgame", 8) == 0) {
+            input_len = 0;
+            free(stdin_value);
+            return OTHELLO_CLIENT_INPUT_ENDGAME;
+          }
+          if (strncmp(stdin_value, "/threads", 8) == 0) {
+            input_len = 0;
+            free(stdin_value);
+            return OTHELLO_CLIENT_INPUT_THREADS;
+          }
         } else {
           if (stdin_real_len > 9) {
             if (strncmp(stdin_value, "/connect", 8) == 0) {
@@ -479,6 +370,30 @@ othello_client_enum_t othello_read_user_input(char **usr_input,
               free(stdin_value);
               return OTHELLO_CLIENT_INPUT_CONNECT;
             }
+            if (strncmp(stdin_value, "/endgame", 8) == 0) {
+              *input_len = stdin_real_len - 8;
+              if ((realloc_input = (char *)realloc(
+                       *usr_input, (*input_len) * sizeof(char))) == NULL) {
+                printf("Error reallocating user_input\n");
+                exit(1);
+              }
+              *usr_input = realloc_input;
+              memcpy(*usr_input, stdin_value + 8, *input_len);
+              free(stdin_value);
+              return OTHELLO_CLIENT_INPUT_ENDGAME;
+            }
+            if (strncmp(stdin_value, "/threads", 8) == 0) {
+              *input_len = stdin_real_len - 8;
+              if ((realloc_input = (char *)realloc(
+                       *usr_input, (*input_len) * sizeof(char))) == NULL) {
+                printf("Error reallocating user_input\n");
+                exit(1);
+              }
+              *usr_input = realloc_input;
+              memcpy(*usr_input, stdin_value + 8, *input_len);
+              free(stdin_value);
+              return OTHELLO_CLIENT_INPUT_THREADS;
+            }
           }
         }
       }
@@ -496,6 +411,12 @@ othello_client_enum_t othello_read_user_input(char **usr_input,
           return OTHELLO_CLIENT_INPUT_LEAVE;
         }
 
+        if (strncmp(stdin_value, "/lobby", 6) == 0) {
+          input_len = 0;
+          free(stdin_value);
+          return OTHELLO_CLIENT_INPUT_LOBBY;
+        }
+
         *input_len = stdin_real_len - 5;
 
         if ((realloc_input = (char *)realloc(
@@ -522,6 +443,18 @@ othello_client_enum_t othello_read_user_input(char **usr_input,
           free(stdin_value);
           return OTHELLO_CLIENT_INPUT_NICK;
         }
+        if (strncmp(stdin_value, "/auto", 5) == 0) {
+          free(stdin_value);
+          return OTHELLO_CLIENT_INPUT_AUTO;
+        }
+        if (strncmp(stdin_value, "/hash", 5) == 0) {
+          free(stdin_value);
+          return OTHELLO_CLIENT_INPUT_HASH;
+        }
+        if (strncmp(stdin_value, "/book", 5) == 0) {
+          free(stdin_value);
+          return OTHELLO_CLIENT_INPUT_BOOK;
+        }
       }
 
       if (stdin_real_len > 8) {
@@ -541,6 +474,15 @@ othello_client_enum_t othello_read_user_input(char **usr_input,
 }
 
 void othello_write_mesg(int sock_descr, char *mesg, size_t msg_len) {
+  char frame[OTHELLO_FRAME_HEADER_LENGTH + 1 + OTHELLO_MESSAGE_LENGTH];
+
+  /* every query but the login is framed, the frame is sent by one write */
+  if (mesg[0] != OTHELLO_QUERY_LOGIN && msg_len < sizeof(frame)) {
+    OTHELLO_FRAME_LENGTH_SET(frame, msg_len);
+    memcpy(frame + OTHELLO_FRAME_HEADER_LENGTH, mesg, msg_len);
+    mesg = frame;
+    msg_len += OTHELLO_FRAME_HEADER_LENGTH;
+  }
   if ((write(sock_descr, mesg, msg_len)) < 0) {
     perror("Error : Impossible to write message to the server ...\n");
     exit(1);
@@ -565,6 +507,7 @@ void othello_display_help() {
   printf("/nick pseudo -> try to log you into the game with the entered "
          "nickname\n");
   printf("/list -> display the list of rooms and their players\n");
+  printf("/lobby -> follow (or stop following) what happens in the rooms\n");
   printf("/join room_number -> try to join the entered room\n");
   printf("/ready -> set you in ready state\n");
   printf("/notready -> set you in unready state\n");
@@ -573,6 +516,12 @@ void othello_display_help() {
   printf("/mesg -> send a message to your opponent\n");
   printf("/leave -> leave the current room\n");
   printf("/auto -> let the AI play for you\n");
+  printf("/auto ms -> let the AI play for you, thinking ms per move\n");
+  printf("/hash MB -> size of the positions table of the AI (0 for none)\n");
+  printf("/endgame n -> let the AI try to play perfectly from n empty "
+         "squares\n");
+  printf("/threads n -> let the AI search with n threads\n");
+  printf("/book path -> let the AI play the openings of a book file\n");
   printf("/exit -> exit the game\n\n");
 }
 
@@ -630,23 +579,32 @@ void othello_choose_nickname(int socket_descriptor, char *usr_inpt,
 }
 
 void othello_ask_list(int socket_descriptor) {
-  char user_input = OTHELLO_QUERY_ROOM_LIST;
   if (client_state == OTHELLO_CLIENT_STATE_CONNECTED) {
-    othello_write_mesg(socket_descriptor, &user_input, sizeof user_input);
+    list_continued = false;
+    othello_ask_list_page(socket_descriptor, 0);
   } else {
     printf("You can't ask the server rooms list now!\n");
   }
 }
 
+void othello_ask_list_page(int socket_descriptor, unsigned short first_room) {
+  char user_input[1 + OTHELLO_ROOM_ID_LENGTH];
+
+  user_input[0] = OTHELLO_QUERY_ROOM_LIST;
+  OTHELLO_ROOM_ID_SET(user_input + 1, first_room);
+  othello_write_mesg(socket_descriptor, user_input, sizeof user_input);
+}
+
 void othello_choose_room(int socket_descriptor, char *usr_inpt,
                          size_t inpt_len) {
-  char user_input[2];
+  char user_input[1 + OTHELLO_ROOM_ID_LENGTH];
 
   if (client_state == OTHELLO_CLIENT_STATE_CONNECTED) {
     if (inpt_len > 1) {
-      if (othello_is_number(usr_inpt + 1)) {
+      if (othello_is_number(usr_inpt + 1) &&
+          atoi(usr_inpt + 1) < OTHELLO_MAX_NUMBER_OF_ROOMS) {
         user_input[0] = OTHELLO_QUERY_ROOM_JOIN;
-        user_input[1] = atoi(usr_inpt + 1);
+        OTHELLO_ROOM_ID_SET(user_input + 1, atoi(usr_inpt + 1));
         othello_write_mesg(socket_descriptor, user_input, sizeof user_input);
         client_state = OTHELLO_CLIENT_STATE_WAITING;
       } else {
@@ -666,6 +624,18 @@ void othello_send_room_leave(socket_descriptor) {
   client_state = OTHELLO_CLIENT_STATE_WAITING;
 }
 
+void othello_send_lobby(int socket_descriptor) {
+  char user_input[2];
+
+  if (client_state != OTHELLO_CLIENT_STATE_NICKNAME) {
+    user_input[0] = OTHELLO_QUERY_LOBBY;
+    user_input[1] = !lobby_subscribed;
+    othello_write_mesg(socket_descriptor, user_input, sizeof user_input);
+  } else {
+    printf("You can't follow the lobby now!\n");
+  }
+}
+
 void othello_send_ready(int socket_descriptor) {
   char user_input = OTHELLO_QUERY_READY;
   if (client_state == OTHELLO_CLIENT_STATE_INROOM) {
@@ -785,77 +755,55 @@ void othello_server_connect(int socket_descriptor) {
 
 void othello_server_room_list(int socket_descriptor) {
   int i;
-  char ereasedVal;
-  char *iterator;
-  int empties[OTHELLO_NUMBER_OF_ROOMS];
-  size_t empties_size;
+  int j;
+  char header[OTHELLO_ROOM_ID_LENGTH + 1];
+  char room[OTHELLO_ROOM_ID_LENGTH + 1];
+  char name[OTHELLO_PLAYER_NAME_LENGTH + 1];
+  unsigned char name_length;
+  int rooms_number;
+  int rooms_count;
   int room_id;
-  char *p1;
-  size_t p1_size;
-  char *p2;
-  size_t p2_size;
-  char server_answer[(2 + OTHELLO_ROOM_LENGTH * OTHELLO_PLAYER_NAME_LENGTH) *
-                     OTHELLO_NUMBER_OF_ROOMS];
-  /* first char for room ID, 32 char for p1, 32 char for p2, 1 char for room
-   * occupation(ignored here) * nb rooms */
-  empties_size = 0;
+  /* header : number of rooms of the server then number of rooms listed */
+  /* each room : 2 char for room ID, 1 char for room occupation, then for each
+   * player 1 char for the name length followed by the name */
+  /* only the non empty rooms are listed */
 
-  othello_read_mesg(socket_descriptor, server_answer, sizeof(server_answer));
-  system("clear");
-  printf("List of rooms :\n\n");
-
-  iterator = server_answer;
-  for (i = 0; i < OTHELLO_NUMBER_OF_ROOMS; ++i) {
-
-    /* place the iterator where we want to start reading, place '\0' where the
-     * reading should end */
-    /* save the ereased char (by '\0') to put it back after */
-    /* if both player names are empty, stock the id into an int array to display
-     * them at the end */
-    /* otherwise, display the room ID with player names into it */
-
-    room_id = *iterator;
-    iterator += 1;
-
-    ereasedVal = *(iterator + 32);
-    *(iterator + 32) = '\0';
-    p1 = iterator;
-    p1_size = strlen(p1);
-    *(iterator + 32) = ereasedVal;
-
-    iterator += 32;
-    ereasedVal = *(iterator + 32);
-    *(iterator + 32) = '\0';
-    p2 = iterator;
-    p2_size = strlen(p2);
-    *(iterator + 32) = ereasedVal;
-
-    if ((p1_size + p2_size) < 1) {
-      empties[empties_size] = room_id;
-      ++empties_size;
-    } else {
-      printf("Room n°%d : ", room_id);
-      if (p1_size > 0) {
-        ereasedVal = *(p1 + 32);
-        *(p1 + 32) = '\0';
-        printf("%s ", p1);
-        *(p1 + 32) = ereasedVal;
-      }
-      if (p2_size > 0) {
-        ereasedVal = *(p2 + 32);
-        *(p2 + 32) = '\0';
-        printf("%s ", p2);
-        *(p2 + 32) = ereasedVal;
+  othello_read_mesg(socket_descriptor, header, sizeof(header));
+  rooms_number = OTHELLO_ROOM_ID_GET(header);
+  rooms_count = (unsigned char)header[OTHELLO_ROOM_ID_LENGTH];
+
+  if (!list_continued) {
+    system("clear");
+    printf("List of rooms :\n\n");
+  }
+
+  room_id = -1;
+  for (i = 0; i < rooms_count; ++i) {
+    othello_read_mesg(socket_descriptor, room, sizeof(room));
+    room_id = OTHELLO_ROOM_ID_GET(room);
+    printf("Room n°%d : ", room_id);
+
+    for (j = 0; j < (unsigned char)room[OTHELLO_ROOM_ID_LENGTH]; ++j) {
+      othello_read_mesg(socket_descriptor, (char *)&name_length, 1);
+      if (name_length > OTHELLO_PLAYER_NAME_LENGTH) {
+        name_length = OTHELLO_PLAYER_NAME_LENGTH;
       }
-      printf("\n");
+      othello_read_mesg(socket_descriptor, name, name_length);
+      name[name_length] = '\0';
+      printf("%s ", name);
     }
-    iterator += 33;
+    printf("\n");
   }
-  printf("\nEmpty rooms : ");
-  for (i = 0; i < empties_size; ++i) {
-    printf("%d ", empties[i]);
+
+  /* a full page may be followed by other rooms, ask the next one */
+  if (rooms_count == OTHELLO_ROOM_LIST_LENGTH && room_id + 1 < rooms_number) {
+    list_continued = true;
+    othello_ask_list_page(socket_descriptor, room_id + 1);
+    return;
   }
-  printf("\n\n");
+
+  printf("\nOther rooms from 0 to %d are empty\n\n", rooms_number - 1);
+  list_continued = false;
   client_state = OTHELLO_CLIENT_STATE_CONNECTED;
 }
 
@@ -889,6 +837,25 @@ void othello_server_room_leave(int socket_descriptor) {
   }
 }
 
+void othello_server_lobby(int socket_descriptor) {
+  char server_answer;
+  othello_read_mesg(socket_descriptor, &server_answer, sizeof(server_answer));
+  if (server_answer == OTHELLO_SUCCESS) {
+    lobby_subscribed = !lobby_subscribed;
+    if (lobby_subscribed) {
+      printf("You are now following the lobby, type /lobby to stop\n");
+      /* the rooms list is the initial state, the events update it */
+      if (client_state == OTHELLO_CLIENT_STATE_CONNECTED) {
+        othello_ask_list(socket_descriptor);
+      }
+    } else {
+      printf("You stopped following the lobby\n");
+    }
+  } else {
+    printf("Server refused to change your lobby subscription ...\n");
+  }
+}
+
 void othello_server_message(int socket_descriptor) {
   char server_answer;
   othello_read_mesg(socket_descriptor, &server_answer, sizeof(server_answer));
@@ -971,6 +938,45 @@ void othello_notif_room_leave(int socket_descriptor) {
   printf("The player '%s' leaved the room!\n", server_answer);
 }
 
+void othello_notif_lobby(int socket_descriptor) {
+  char server_answer[OTHELLO_ROOM_ID_LENGTH + 1 + OTHELLO_PLAYER_NAME_LENGTH];
+  char name[OTHELLO_PLAYER_NAME_LENGTH + 1];
+  /* 2 char for room ID, 1 char for the event, then the player name */
+  othello_read_mesg(socket_descriptor, server_answer, sizeof(server_answer));
+  memcpy(name, server_answer + OTHELLO_ROOM_ID_LENGTH + 1,
+         OTHELLO_PLAYER_NAME_LENGTH);
+  name[OTHELLO_PLAYER_NAME_LENGTH] = '\0';
+
+  printf("Room n°%d : ", OTHELLO_ROOM_ID_GET(server_answer));
+  switch (server_answer[OTHELLO_ROOM_ID_LENGTH]) {
+  case OTHELLO_LOBBY_ROOM_JOIN:
+    printf("'%s' joined\n", name);
+    break;
+  case OTHELLO_LOBBY_ROOM_LEAVE:
+    printf("'%s' leaved\n", name);
+    break;
+  case OTHELLO_LOBBY_READY:
+    printf("'%s' is ready\n", name);
+    break;
+  case OTHELLO_LOBBY_NOT_READY:
+    printf("'%s' is not ready\n", name);
+    break;
+  case OTHELLO_LOBBY_GAME_START:
+    printf("game started\n");
+    break;
+  case OTHELLO_LOBBY_GAME_END:
+    if (name[0] != '\0') {
+      printf("game ended, '%s' won\n", name);
+    } else {
+      printf("game ended\n");
+    }
+    break;
+  default:
+    printf("unknown event\n");
+    break;
+  }
+}
+
 void othello_notif_mesg(int socket_descriptor) {
   char server_answer_user_name[32];
   char server_answer_message[OTHELLO_MESSAGE_LENGTH];
@@ -1015,11 +1021,11 @@ void othello_notif_your_turn(int socket_descriptor) {
 void othello_notif_start(int socket_descriptor) {
   char server_answer;
   othello_read_mesg(socket_descriptor, &server_answer, sizeof(server_answer));
+  /* every game starts from the initial setup */
+  othello_board_init(&othello_board);
   if (server_answer) {
-    my_color =
-        othello_board[OTHELLO_BOARD_LENGTH / 2 - 1][OTHELLO_BOARD_LENGTH / 2];
-    opponent_color = othello_board[OTHELLO_BOARD_LENGTH / 2 -
-                                   1][OTHELLO_BOARD_LENGTH / 2 - 1];
+    my_color = othello_colors[OTHELLO_BOARD_BLACK];
+    opponent_color = othello_colors[OTHELLO_BOARD_WHITE];
     client_state = OTHELLO_CLIENT_STATE_PLAYING;
     system("clear");
     printf("Your play with '%c' tokens!\n", my_color);
@@ -1028,10 +1034,8 @@ void othello_notif_start(int socket_descriptor) {
     if (auto_mode)
       othello_send_auto_move(socket_descriptor);
   } else {
-    my_color = othello_board[OTHELLO_BOARD_LENGTH / 2 -
-                             1][OTHELLO_BOARD_LENGTH / 2 - 1];
-    opponent_color =
-        othello_board[OTHELLO_BOARD_LENGTH / 2 - 1][OTHELLO_BOARD_LENGTH / 2];
+    my_color = othello_colors[OTHELLO_BOARD_WHITE];
+    opponent_color = othello_colors[OTHELLO_BOARD_BLACK];
     client_state = OTHELLO_CLIENT_STATE_WAITING;
     system("clear");
     printf("Your play with '%c' tokens!\n", my_color);
@@ -1048,14 +1052,17 @@ void othello_notif_giveup(int socket_descriptor) {
 }
 
 void othello_notif_end(int socket_descriptor) {
-  char server_answer;
-  othello_read_mesg(socket_descriptor, &server_answer, sizeof(server_answer));
+  char server_answer[3];
+  /* first char for the result, then my tokens and opponent tokens */
+  othello_read_mesg(socket_descriptor, server_answer, sizeof(server_answer));
   system("clear");
   othello_display_board();
-  if (server_answer) {
-    printf("Game ended, you won!\n");
+  if (server_answer[0]) {
+    printf("Game ended, you won %d to %d!\n", server_answer[1],
+           server_answer[2]);
   } else {
-    printf("Game ended, you lost!\n");
+    printf("Game ended, you lost %d to %d!\n", server_answer[1],
+           server_answer[2]);
   }
   client_state = OTHELLO_CLIENT_STATE_INROOM;
   printf("You can use /ready to start a new one or /leave to exit the room\n");
@@ -1096,6 +1103,9 @@ void *othello_write_thread(void *sock) {
       case OTHELLO_CLIENT_INPUT_LEAVE:
         othello_send_room_leave(socket_descriptor);
         break;
+      case OTHELLO_CLIENT_INPUT_LOBBY:
+        othello_send_lobby(socket_descriptor);
+        break;
       case OTHELLO_CLIENT_INPUT_READY:
         othello_send_ready(socket_descriptor);
         break;
@@ -1115,9 +1125,19 @@ void *othello_write_thread(void *sock) {
         othello_send_mesg(socket_descriptor, usr_input, input_len);
         break;
       case OTHELLO_CLIENT_INPUT_AUTO:
-        auto_mode = !auto_mode;
-        if (client_state == OTHELLO_CLIENT_STATE_PLAYING)
-          othello_send_auto_move(socket_descriptor);
+        othello_set_auto(socket_descriptor, usr_input, input_len);
+        break;
+      case OTHELLO_CLIENT_INPUT_HASH:
+        othello_set_hash(usr_input, input_len);
+        break;
+      case OTHELLO_CLIENT_INPUT_ENDGAME:
+        othello_set_endgame(usr_input, input_len);
+        break;
+      case OTHELLO_CLIENT_INPUT_THREADS:
+        othello_set_threads(usr_input, input_len);
+        break;
+      case OTHELLO_CLIENT_INPUT_BOOK:
+        othello_set_book(usr_input, input_len);
         break;
       case OTHELLO_CLIENT_INPUT_EXIT:
         othello_send_exit(socket_descriptor);
@@ -1162,6 +1182,9 @@ void *othello_read_thread(void *sock) {
     case OTHELLO_QUERY_GIVE_UP:
       othello_server_giveup(socket_descriptor);
       break;
+    case OTHELLO_QUERY_LOBBY:
+      othello_server_lobby(socket_descriptor);
+      break;
 
     case OTHELLO_NOTIF_ROOM_JOIN:
       othello_notif_room_join(socket_descriptor);
@@ -1195,6 +1218,9 @@ void *othello_read_thread(void *sock) {
       auto_mode = false;
       othello_notif_end(socket_descriptor);
       break;
+    case OTHELLO_NOTIF_LOBBY:
+      othello_notif_lobby(socket_descriptor);
+      break;
     default:
       break;
     }
@@ -29,9 +29,14 @@ enum othello_client_enum_e {
   OTHELLO_CLIENT_INPUT_PLAY,
   OTHELLO_CLIENT_INPUT_MESG,
   OTHELLO_CLIENT_INPUT_AUTO,
+  OTHELLO_CLIENT_INPUT_HASH,
+  OTHELLO_CLIENT_INPUT_ENDGAME,
+  OTHELLO_CLIENT_INPUT_THREADS,
+  OTHELLO_CLIENT_INPUT_BOOK,
   OTHELLO_CLIENT_INPUT_HELP,
   OTHELLO_CLIENT_INPUT_GIVEUP,
   OTHELLO_CLIENT_INPUT_LEAVE,
+  OTHELLO_CLIENT_INPUT_LOBBY,
   OTHELLO_CLIENT_INPUT_EXIT,
   OTHELLO_CLIENT_INPUT_FAIL
 };
@@ -47,7 +52,9 @@ void othello_init_board();
 void othello_display_board();
 /* return if yes or not a char* can be converted into a number */
 bool othello_is_number(char *);
-/* return all tokens affected by the new token just placed */
+/* return the board side playing with the given token color */
+int othello_color_side(char);
+/* place the new token and return all tokens affected by it */
 void othello_return_tokens(int, int, char);
 /* place a token on the board and call othello_return_tokens */
 void othello_place_token(int, char);
@@ -55,8 +62,18 @@ void othello_place_token(int, char);
 int othello_move_valid(int, int, char);
 /* display the list of possible moves to the user */
 void othello_display_moves();
-/* used for the AI, calculating the move return the higher number of tokens */
+/* used for the AI, search the best move within the time budget */
 void othello_calc_best_move(int *, int *);
+/* turn the AI on or off, or set its time budget per move */
+void othello_set_auto(int, char *, size_t);
+/* show or set the size in MB of the positions table of the AI */
+void othello_set_hash(char *, size_t);
+/* show or set from how many empty squares the AI solves the game exactly */
+void othello_set_endgame(char *, size_t);
+/* show or set the count of threads of the AI search */
+void othello_set_threads(char *, size_t);
+/* show the opening book of the AI or map another book file */
+void othello_set_book(char *, size_t);
 
 /************************************/
 /***** INPUT/OUTPUT FUNCTIONS *******/
@@ -79,10 +96,14 @@ hostent *othello_ask_server_adress();
 void othello_choose_nickname(int, char *, size_t);
 /* request the rooms list to the server */
 void othello_ask_list(int);
+/* request the rooms list to the server from a room ID */
+void othello_ask_list_page(int, unsigned short);
 /* try to connect the user into a room */
 void othello_choose_room(int, char *, size_t);
 /* try to leave the user current room */
 void othello_send_room_leave(int);
+/* subscribe to the lobby events or unsubscribe from them */
+void othello_send_lobby(int);
 /* try to put the user into a ready state (ready to play) */
 void othello_send_ready(int);
 /* try to put the user into an unready state */
@@ -108,6 +129,8 @@ void othello_server_room_list(int);
 void othello_server_room_join(int);
 /* server is answering if yes or not the user succed to leave a room */
 void othello_server_room_leave(int);
+/* server is answering if yes or not the user is (un)subscribed to the lobby */
+void othello_server_lobby(int);
 /* server is answering if yes or not the user succed to send a message */
 void othello_server_message(int);
 /* server is answering if yes or not the user is allowed to be ready */
@@ -139,6 +162,8 @@ void othello_notif_start(int);
 void othello_notif_giveup(int);
 /* notif the user that the game ends */
 void othello_notif_end(int);
+/* notif the user of an event in a room of the server */
+void othello_notif_lobby(int);
 
 /************************************/
 /******** THREAD FUNCTIONS **********/
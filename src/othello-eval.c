@@ -0,0 +1,381 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-eval.h"
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define OTHELLO_EVAL_SSSE3
+#include <immintrin.h>
+#endif
+
+#define OTHELLO_EVAL_LINE 8   /*squares of an edge or a diagonal*/
+#define OTHELLO_EVAL_CORNER 9 /*squares of a 3x3 corner*/
+#define OTHELLO_EVAL_LINE_CONFIGURATIONS 6561    /*3^8*/
+#define OTHELLO_EVAL_CORNER_CONFIGURATIONS 19683 /*3^9*/
+#define OTHELLO_EVAL_EDGES 0 /*offsets of the tables in othello_eval_weights*/
+#define OTHELLO_EVAL_CORNERS OTHELLO_EVAL_LINE_CONFIGURATIONS
+#define OTHELLO_EVAL_DIAGONALS                                                 \
+  (OTHELLO_EVAL_CORNERS + OTHELLO_EVAL_CORNER_CONFIGURATIONS)
+#define OTHELLO_EVAL_WEIGHTS                                                   \
+  (OTHELLO_EVAL_DIAGONALS + OTHELLO_EVAL_LINE_CONFIGURATIONS)
+#define OTHELLO_EVAL_MOBILITY_WEIGHT 16
+#define OTHELLO_EVAL_FRONTIER_WEIGHT 3
+#define OTHELLO_EVAL_STABLE_WEIGHT 10
+#define OTHELLO_EVAL_EXPOSED_WEIGHT 30
+
+#define OTHELLO_EVAL_COLUMN_0 UINT64_C(0x0101010101010101)
+#define OTHELLO_EVAL_DIAGONAL UINT64_C(0x8040201008040201)
+
+/**
+ * index of a pattern in base 3, the digit of a square is 0 if it is empty, 1
+ * if side owns it and 2 if the opponent owns it, othello_eval_ternary turns
+ * the bits of the squares of one side into their digits
+ */
+static int othello_eval_ternary[1 << OTHELLO_EVAL_CORNER];
+
+/**
+ * weights of the edges, the corners and the diagonals, 16 bits wide to keep
+ * the tables in the cache
+ */
+static int16_t othello_eval_weights[OTHELLO_EVAL_WEIGHTS];
+
+/**
+ * table of each pattern, in the order of othello_eval_bits
+ */
+static const int othello_eval_offsets[OTHELLO_EVAL_PATTERNS] = {
+    OTHELLO_EVAL_EDGES,     OTHELLO_EVAL_EDGES,   OTHELLO_EVAL_EDGES,
+    OTHELLO_EVAL_EDGES,     OTHELLO_EVAL_CORNERS, OTHELLO_EVAL_CORNERS,
+    OTHELLO_EVAL_CORNERS,   OTHELLO_EVAL_CORNERS, OTHELLO_EVAL_DIAGONALS,
+    OTHELLO_EVAL_DIAGONALS};
+
+/**
+ * value of the squares of an edge, the corners are shared by two edges
+ */
+static const int othello_eval_edge_squares[OTHELLO_EVAL_LINE] = {
+    50, -20, 10, 5, 5, 10, -20, 50};
+
+static int (*othello_eval_implementation)(const othello_board_t *, int);
+
+/**
+ *
+ */
+static int othello_eval_sign(int digit) {
+  return digit == 1 ? 1 : (digit == 2 ? -1 : 0);
+}
+
+/**
+ * the squares next to a corner give it away while it is empty, the discs
+ * of a line starting from an owned corner cannot be flipped anymore
+ */
+static int othello_eval_edge(const int *digits) {
+  int value, stable, k;
+
+  value = 0;
+  for (k = 0; k < OTHELLO_EVAL_LINE; k++) {
+    value += othello_eval_sign(digits[k]) * othello_eval_edge_squares[k];
+  }
+  if (digits[0] != 0) {
+    value += othello_eval_sign(digits[1]) * 25;
+  }
+  if (digits[OTHELLO_EVAL_LINE - 1] != 0) {
+    value += othello_eval_sign(digits[OTHELLO_EVAL_LINE - 2]) * 25;
+  }
+
+  stable = 0;
+  while (stable < OTHELLO_EVAL_LINE && digits[stable] == digits[0]) {
+    stable++;
+  }
+  value += othello_eval_sign(digits[0]) * stable * OTHELLO_EVAL_STABLE_WEIGHT;
+
+  /*a full line of one side is counted once*/
+  if (stable < OTHELLO_EVAL_LINE) {
+    stable = 0;
+    while (digits[OTHELLO_EVAL_LINE - 1 - stable] ==
+           digits[OTHELLO_EVAL_LINE - 1]) {
+      stable++;
+    }
+    value += othello_eval_sign(digits[OTHELLO_EVAL_LINE - 1]) * stable *
+             OTHELLO_EVAL_STABLE_WEIGHT;
+  }
+
+  return value;
+}
+
+/**
+ * squares of a 3x3 corner row by row from the corner, the edge squares are
+ * valued by the edges
+ */
+static int othello_eval_corner(const int *digits) {
+  return othello_eval_sign(digits[4]) * (digits[0] == 0 ? -50 : 5) -
+         2 * othello_eval_sign(digits[5]) - 2 * othello_eval_sign(digits[7]) +
+         othello_eval_sign(digits[8]);
+}
+
+/**
+ * a disc next to an empty corner followed by discs of the same side and a
+ * disc of the other side lets the other side take the corner
+ */
+static int othello_eval_exposed(const int *digits) {
+  int k;
+
+  if (digits[0] != 0 || digits[1] == 0) {
+    return 0;
+  }
+  k = 1;
+  while (k < OTHELLO_EVAL_LINE - 1 && digits[k] == digits[1]) {
+    k++;
+  }
+  if (digits[k] != 0 && digits[k] != digits[1]) {
+    return -othello_eval_sign(digits[1]) * OTHELLO_EVAL_EXPOSED_WEIGHT;
+  }
+
+  return 0;
+}
+
+/**
+ * the corners and the squares next to them are valued by the other patterns
+ */
+static int othello_eval_diagonal(const int *digits) {
+  int reversed[OTHELLO_EVAL_LINE];
+  int k;
+
+  for (k = 0; k < OTHELLO_EVAL_LINE; k++) {
+    reversed[k] = digits[OTHELLO_EVAL_LINE - 1 - k];
+  }
+
+  return othello_eval_sign(digits[2]) + othello_eval_sign(digits[5]) +
+         othello_eval_exposed(digits) + othello_eval_exposed(reversed);
+}
+
+/**
+ * fill the weights of every configuration of a pattern
+ */
+static void othello_eval_fill(int16_t *weights, int squares,
+                              int (*value)(const int *)) {
+  int digits[OTHELLO_EVAL_CORNER];
+  int configurations, index, rest, k;
+
+  for (configurations = 1, k = 0; k < squares; k++) {
+    configurations *= 3;
+  }
+  for (index = 0; index < configurations; index++) {
+    for (rest = index, k = 0; k < squares; k++, rest /= 3) {
+      digits[k] = rest % 3;
+    }
+    weights[index] = value(digits);
+  }
+}
+
+/**
+ * reverse the columns of a bitboard
+ */
+static othello_bitboard_t othello_eval_mirror(othello_bitboard_t bitboard) {
+  bitboard = ((bitboard >> 1) & UINT64_C(0x5555555555555555)) |
+             ((bitboard & UINT64_C(0x5555555555555555)) << 1);
+  bitboard = ((bitboard >> 2) & UINT64_C(0x3333333333333333)) |
+             ((bitboard & UINT64_C(0x3333333333333333)) << 2);
+  bitboard = ((bitboard >> 4) & UINT64_C(0x0f0f0f0f0f0f0f0f)) |
+             ((bitboard & UINT64_C(0x0f0f0f0f0f0f0f0f)) << 4);
+
+  return bitboard;
+}
+
+/**
+ * bits of the squares of every pattern, the board is mirrored so that each
+ * pattern is read from the first row and the first column, starting at its
+ * corner
+ */
+static void othello_eval_bits(othello_bitboard_t bitboard, int *bits) {
+  othello_bitboard_t mirrored, flipped, both;
+
+  mirrored = othello_eval_mirror(bitboard);
+  flipped = __builtin_bswap64(bitboard);
+  both = __builtin_bswap64(mirrored);
+
+  bits[0] = bitboard & 0xff;
+  bits[1] = flipped & 0xff;
+  bits[2] = ((bitboard & OTHELLO_EVAL_COLUMN_0) *
+             UINT64_C(0x0102040810204080)) >> 56;
+  bits[3] = ((mirrored & OTHELLO_EVAL_COLUMN_0) *
+             UINT64_C(0x0102040810204080)) >> 56;
+  bits[4] = (bitboard & 0x7) | ((bitboard >> 5) & 0x38) |
+            ((bitboard >> 10) & 0x1c0);
+  bits[5] = (mirrored & 0x7) | ((mirrored >> 5) & 0x38) |
+            ((mirrored >> 10) & 0x1c0);
+  bits[6] = (flipped & 0x7) | ((flipped >> 5) & 0x38) |
+            ((flipped >> 10) & 0x1c0);
+  bits[7] = (both & 0x7) | ((both >> 5) & 0x38) | ((both >> 10) & 0x1c0);
+  bits[8] = ((bitboard & OTHELLO_EVAL_DIAGONAL) *
+             UINT64_C(0x0101010101010101)) >> 56;
+  bits[9] = ((mirrored & OTHELLO_EVAL_DIAGONAL) *
+             UINT64_C(0x0101010101010101)) >> 56;
+}
+
+/**
+ * strokes of each side now and squares where the opponent may play later
+ */
+static int othello_eval_mobility(const othello_board_t *board, int side) {
+  return OTHELLO_EVAL_MOBILITY_WEIGHT *
+             (othello_bitboard_count(othello_board_moves(board, side)) -
+              othello_bitboard_count(othello_board_moves(board, !side))) +
+         OTHELLO_EVAL_FRONTIER_WEIGHT *
+             (othello_bitboard_count(othello_board_frontier(board, !side)) -
+              othello_bitboard_count(othello_board_frontier(board, side)));
+}
+
+/**
+ * sum of the weights of the patterns from the bits of both sides
+ */
+static int othello_eval_sum(const int *own, const int *opponent) {
+  int score, i;
+
+  score = 0;
+  for (i = 0; i < OTHELLO_EVAL_PATTERNS; i++) {
+    score += othello_eval_weights[othello_eval_offsets[i] +
+                                  othello_eval_ternary[own[i]] +
+                                  2 * othello_eval_ternary[opponent[i]]];
+  }
+
+  return score;
+}
+
+/**
+ *
+ */
+int othello_eval_scalar(const othello_board_t *board, int side) {
+  int own[OTHELLO_EVAL_PATTERNS], opponent[OTHELLO_EVAL_PATTERNS];
+
+  othello_eval_bits(board->discs[side], own);
+  othello_eval_bits(board->discs[!side], opponent);
+
+  return othello_eval_sum(own, opponent) + othello_eval_mobility(board, side);
+}
+
+#ifdef OTHELLO_EVAL_SSSE3
+/**
+ * 3x3 corner of the first row and the first column of both sides at once
+ */
+__attribute__((target("ssse3"))) static __m128i
+othello_eval_corner_bits(__m128i discs) {
+  return _mm_or_si128(
+      _mm_and_si128(discs, _mm_set1_epi64x(0x7)),
+      _mm_or_si128(
+          _mm_and_si128(_mm_srli_epi64(discs, 5), _mm_set1_epi64x(0x38)),
+          _mm_and_si128(_mm_srli_epi64(discs, 10), _mm_set1_epi64x(0x1c0))));
+}
+
+/**
+ * both sides are held by the two halves of one register: the columns are
+ * reversed and the rows swapped by byte shuffles, the first and the last
+ * columns are read by the sign bits of the bytes and the diagonals by a sum of
+ * the bytes, the squares of a diagonal being on different columns
+ */
+__attribute__((target("ssse3"))) static int
+othello_eval_ssse3(const othello_board_t *board, int side) {
+  int own[OTHELLO_EVAL_PATTERNS], opponent[OTHELLO_EVAL_PATTERNS];
+  __m128i discs, mirrored, flipped, both, nibbles, swap, diagonal, bits;
+  int columns;
+
+  swap = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+  nibbles = _mm_set1_epi8(0x0f);
+  diagonal = _mm_set1_epi64x((int64_t)OTHELLO_EVAL_DIAGONAL);
+
+  discs = _mm_set_epi64x((int64_t)board->discs[!side],
+                         (int64_t)board->discs[side]);
+  mirrored = _mm_or_si128(
+      _mm_shuffle_epi8(_mm_set_epi8(15, 7, 11, 3, 13, 5, 9, 1, 14, 6, 10, 2,
+                                    12, 4, 8, 0),
+                       _mm_and_si128(_mm_srli_epi16(discs, 4), nibbles)),
+      _mm_shuffle_epi8(_mm_set_epi8(-16, 112, -80, 48, -48, 80, -112, 16, -32,
+                                    96, -96, 32, -64, 64, -128, 0),
+                       _mm_and_si128(discs, nibbles)));
+  flipped = _mm_shuffle_epi8(discs, swap);
+  both = _mm_shuffle_epi8(mirrored, swap);
+
+  own[0] = board->discs[side] & 0xff;
+  opponent[0] = board->discs[!side] & 0xff;
+  own[1] = board->discs[side] >> 56;
+  opponent[1] = board->discs[!side] >> 56;
+  columns = _mm_movemask_epi8(_mm_slli_epi64(discs, 7));
+  own[2] = columns & 0xff;
+  opponent[2] = columns >> 8;
+  columns = _mm_movemask_epi8(discs);
+  own[3] = columns & 0xff;
+  opponent[3] = columns >> 8;
+
+  bits = othello_eval_corner_bits(discs);
+  own[4] = _mm_cvtsi128_si32(bits);
+  opponent[4] = _mm_cvtsi128_si32(_mm_unpackhi_epi64(bits, bits));
+  bits = othello_eval_corner_bits(mirrored);
+  own[5] = _mm_cvtsi128_si32(bits);
+  opponent[5] = _mm_cvtsi128_si32(_mm_unpackhi_epi64(bits, bits));
+  bits = othello_eval_corner_bits(flipped);
+  own[6] = _mm_cvtsi128_si32(bits);
+  opponent[6] = _mm_cvtsi128_si32(_mm_unpackhi_epi64(bits, bits));
+  bits = othello_eval_corner_bits(both);
+  own[7] = _mm_cvtsi128_si32(bits);
+  opponent[7] = _mm_cvtsi128_si32(_mm_unpackhi_epi64(bits, bits));
+
+  bits = _mm_sad_epu8(_mm_and_si128(discs, diagonal), _mm_setzero_si128());
+  own[8] = _mm_cvtsi128_si32(bits);
+  opponent[8] = _mm_cvtsi128_si32(_mm_unpackhi_epi64(bits, bits));
+  bits = _mm_sad_epu8(_mm_and_si128(mirrored, diagonal), _mm_setzero_si128());
+  own[9] = _mm_cvtsi128_si32(bits);
+  opponent[9] = _mm_cvtsi128_si32(_mm_unpackhi_epi64(bits, bits));
+
+  return othello_eval_sum(own, opponent) + othello_eval_mobility(board, side);
+}
+#endif
+
+/**
+ *
+ */
+void othello_eval_init(void) {
+  int bits, digit, k;
+
+  if (othello_eval_implementation != NULL) {
+    return;
+  }
+
+  for (bits = 0; bits < (1 << OTHELLO_EVAL_CORNER); bits++) {
+    othello_eval_ternary[bits] = 0;
+    for (digit = 1, k = 0; k < OTHELLO_EVAL_CORNER; k++, digit *= 3) {
+      if (bits & (1 << k)) {
+        othello_eval_ternary[bits] += digit;
+      }
+    }
+  }
+
+  othello_eval_fill(othello_eval_weights + OTHELLO_EVAL_EDGES,
+                    OTHELLO_EVAL_LINE, othello_eval_edge);
+  othello_eval_fill(othello_eval_weights + OTHELLO_EVAL_CORNERS,
+                    OTHELLO_EVAL_CORNER, othello_eval_corner);
+  othello_eval_fill(othello_eval_weights + OTHELLO_EVAL_DIAGONALS,
+                    OTHELLO_EVAL_LINE, othello_eval_diagonal);
+
+  othello_eval_implementation = othello_eval_scalar;
+#ifdef OTHELLO_EVAL_SSSE3
+  if (__builtin_cpu_supports("ssse3")) {
+    othello_eval_implementation = othello_eval_ssse3;
+  }
+#endif
+}
+
+/**
+ *
+ */
+int othello_eval(const othello_board_t *board, int side) {
+  return othello_eval_implementation(board, side);
+}
+
+/**
+ *
+ */
+bool othello_eval_vectorized(void) {
+  return othello_eval_implementation != othello_eval_scalar;
+}
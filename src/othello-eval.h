@@ -0,0 +1,42 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_EVAL_H
+#define OTHELLO_EVAL_H
+
+#include "othello-board.h"
+
+#include <stdbool.h>
+
+#define OTHELLO_EVAL_PATTERNS 10 /*4 edges, 4 corners and 2 diagonals*/
+
+/**
+ * fill the weight tables of the patterns and pick the fastest implementation
+ * the processor supports, called once before any evaluation
+ */
+void othello_eval_init(void);
+
+/**
+ * sum of the weights of the patterns of a position plus the differences of
+ * mobility and frontier
+ * \param board current board
+ * \param side side to play
+ * \return a score for side, positive if side is ahead
+ */
+int othello_eval(const othello_board_t *board, int side);
+
+/**
+ * evaluation without vector instructions
+ * \param board current board
+ * \param side side to play
+ * \return the same score as othello_eval
+ */
+int othello_eval_scalar(const othello_board_t *board, int side);
+
+/**
+ * \return true if othello_eval uses vector instructions
+ */
+bool othello_eval_vectorized(void);
+
+#endif
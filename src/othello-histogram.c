@@ -0,0 +1,134 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-histogram.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/**
+ * values below OTHELLO_HISTOGRAM_SUB_BUCKETS have their own bucket, the
+ * others are indexed by their highest bit then by the next bits
+ */
+static int othello_histogram_bucket(uint64_t value) {
+  int shift;
+
+  if (value < OTHELLO_HISTOGRAM_SUB_BUCKETS) {
+    return value;
+  }
+
+  shift = 63 - __builtin_clzll(value) - OTHELLO_HISTOGRAM_SUB_BITS;
+
+  return (shift + 1) * OTHELLO_HISTOGRAM_SUB_BUCKETS +
+         ((value >> shift) & (OTHELLO_HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+/**
+ * \return the highest value counted in a bucket
+ */
+static uint64_t othello_histogram_highest(int bucket) {
+  int shift;
+  uint64_t lowest;
+
+  if (bucket < OTHELLO_HISTOGRAM_SUB_BUCKETS) {
+    return bucket;
+  }
+
+  shift = bucket / OTHELLO_HISTOGRAM_SUB_BUCKETS - 1;
+  lowest = (uint64_t)(OTHELLO_HISTOGRAM_SUB_BUCKETS +
+                      bucket % OTHELLO_HISTOGRAM_SUB_BUCKETS)
+           << shift;
+
+  return lowest + ((UINT64_C(1) << shift) - 1);
+}
+
+/**
+ *
+ */
+void othello_histogram_init(othello_histogram_t *histogram) {
+  memset(histogram, 0, sizeof(othello_histogram_t));
+}
+
+/**
+ *
+ */
+void othello_histogram_record(othello_histogram_t *histogram,
+                              uint64_t value) {
+  histogram->counts[othello_histogram_bucket(value)]++;
+  histogram->count++;
+  histogram->sum += value;
+  if (value > histogram->max) {
+    histogram->max = value;
+  }
+}
+
+/**
+ * relaxed atomics, only the counts matter, not their order
+ */
+void othello_histogram_record_shared(othello_histogram_t *histogram,
+                                     uint64_t value) {
+  uint64_t max;
+
+  __atomic_add_fetch(histogram->counts + othello_histogram_bucket(value), 1,
+                     __ATOMIC_RELAXED);
+  __atomic_add_fetch(&(histogram->count), 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&(histogram->sum), value, __ATOMIC_RELAXED);
+  max = __atomic_load_n(&(histogram->max), __ATOMIC_RELAXED);
+  while (value > max &&
+         !__atomic_compare_exchange_n(&(histogram->max), &max, value, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+/**
+ * other may be written meanwhile, each count is read once
+ */
+void othello_histogram_merge(othello_histogram_t *histogram,
+                             const othello_histogram_t *other) {
+  int bucket;
+  uint64_t max;
+
+  for (bucket = 0; bucket < OTHELLO_HISTOGRAM_BUCKETS; bucket++) {
+    histogram->counts[bucket] +=
+        __atomic_load_n(other->counts + bucket, __ATOMIC_RELAXED);
+  }
+  histogram->count += __atomic_load_n(&(other->count), __ATOMIC_RELAXED);
+  histogram->sum += __atomic_load_n(&(other->sum), __ATOMIC_RELAXED);
+  if ((max = __atomic_load_n(&(other->max), __ATOMIC_RELAXED)) >
+      histogram->max) {
+    histogram->max = max;
+  }
+}
+
+/**
+ * the bucket bound is clipped to the largest value recorded
+ */
+uint64_t othello_histogram_percentile(const othello_histogram_t *histogram,
+                                      double fraction) {
+  uint64_t rank, seen, highest;
+  int bucket;
+
+  if (histogram->count == 0) {
+    return 0;
+  }
+
+  rank = (uint64_t)(fraction * histogram->count);
+  if (rank >= histogram->count) {
+    rank = histogram->count - 1;
+  }
+
+  seen = 0;
+  for (bucket = 0; bucket < OTHELLO_HISTOGRAM_BUCKETS; bucket++) {
+    seen += histogram->counts[bucket];
+    if (seen > rank) {
+      break;
+    }
+  }
+
+  highest = othello_histogram_highest(bucket);
+
+  return highest < histogram->max ? highest : histogram->max;
+}
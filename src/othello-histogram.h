@@ -0,0 +1,71 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_HISTOGRAM_H
+#define OTHELLO_HISTOGRAM_H
+
+#include <stdint.h>
+
+/**
+ * log-linear buckets as in HDR histograms, 16 buckets per power of 2 so a
+ * value is known within 6%
+ */
+#define OTHELLO_HISTOGRAM_SUB_BUCKETS 16
+#define OTHELLO_HISTOGRAM_SUB_BITS 4
+#define OTHELLO_HISTOGRAM_BUCKETS                                              \
+  ((64 - OTHELLO_HISTOGRAM_SUB_BITS + 1) * OTHELLO_HISTOGRAM_SUB_BUCKETS)
+
+/**
+ * counts of the recorded values, read safely by any thread while it is
+ * written
+ */
+struct othello_histogram_s {
+  uint64_t counts[OTHELLO_HISTOGRAM_BUCKETS];
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+};
+
+typedef struct othello_histogram_s othello_histogram_t;
+
+/**
+ * empty a histogram
+ * \param histogram histogram to initialize
+ */
+void othello_histogram_init(othello_histogram_t *histogram);
+
+/**
+ * count a value
+ * \param histogram current histogram
+ * \param value value to record, a duration in nanoseconds for instance
+ */
+void othello_histogram_record(othello_histogram_t *histogram, uint64_t value);
+
+/**
+ * count a value in a histogram written by several threads at once
+ * \param histogram current histogram
+ * \param value value to record
+ */
+void othello_histogram_record_shared(othello_histogram_t *histogram,
+                                     uint64_t value);
+
+/**
+ * add the counts of a histogram to another one
+ * \param histogram histogram to fill
+ * \param other histogram to add
+ */
+void othello_histogram_merge(othello_histogram_t *histogram,
+                             const othello_histogram_t *other);
+
+/**
+ * value below which a fraction of the recorded values are
+ * \param histogram current histogram
+ * \param fraction fraction of the values, 0.99 for the 99th percentile
+ * \return the highest value of the bucket of the percentile, 0 if the
+ * histogram is empty
+ */
+uint64_t othello_histogram_percentile(const othello_histogram_t *histogram,
+                                      double fraction);
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-journal.h"
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * print a record on one line
+ */
+static void othello_journal_print(othello_journal_record_t *record) {
+  printf("%lu.%09lu player %u ",
+         (unsigned long)(record->time / UINT64_C(1000000000)),
+         (unsigned long)(record->time % UINT64_C(1000000000)), record->player);
+  if (record->room == OTHELLO_JOURNAL_NO_ROOM) {
+    printf("lobby");
+  } else {
+    printf("room %u", record->room);
+  }
+  printf(" %s", othello_journal_event_name(record->event));
+
+  switch (record->event) {
+  case OTHELLO_JOURNAL_PLAY:
+    printf(" [%d,%d]", record->value / OTHELLO_BOARD_LENGTH,
+           record->value % OTHELLO_BOARD_LENGTH);
+    break;
+  case OTHELLO_JOURNAL_GAME_END:
+    printf(" side %d", record->value);
+    break;
+  default:
+    break;
+  }
+
+  printf(" %.*s\n", OTHELLO_PLAYER_NAME_LENGTH, record->name);
+}
+
+/**
+ * records are scanned in place from the mapping of the file
+ * \return -1 if the file cannot be read
+ */
+static int othello_journal_scan(const char *path, bool count,
+                                unsigned long *counts) {
+  othello_journal_record_t *records, *record_cursor;
+  struct stat stat_buf;
+  size_t length;
+  int fd;
+
+  if ((fd = open(path, O_RDONLY)) < 0) {
+    return -1;
+  }
+  if (fstat(fd, &stat_buf) < 0) {
+    close(fd);
+    return -1;
+  }
+
+  length = stat_buf.st_size / sizeof(othello_journal_record_t);
+  if (length == 0) {
+    close(fd);
+    return 0;
+  }
+
+  if ((records = mmap(NULL, length * sizeof(othello_journal_record_t),
+                      PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+  close(fd);
+  madvise(records, length * sizeof(othello_journal_record_t),
+          MADV_SEQUENTIAL);
+
+  /*records not written yet are skipped, a crash may leave holes*/
+  for (record_cursor = records; record_cursor < records + length;
+       record_cursor++) {
+    if (record_cursor->event == OTHELLO_JOURNAL_NONE) {
+      continue;
+    }
+    if (count) {
+      if (record_cursor->event <= OTHELLO_JOURNAL_GAME_END) {
+        counts[record_cursor->event]++;
+      }
+    } else {
+      othello_journal_print(record_cursor);
+    }
+  }
+
+  munmap(records, length * sizeof(othello_journal_record_t));
+
+  return 0;
+}
+
+/**
+ *
+ */
+static void othello_journal_print_help(void) {
+  printf("Usage: othello-journal-dump [-c | --count] <segment file>...\n");
+}
+
+/**
+ *
+ */
+int main(int argc, char *argv[]) {
+  unsigned long counts[OTHELLO_JOURNAL_GAME_END + 1];
+  bool count;
+  int option;
+  int event;
+  char *short_options = "hc";
+  struct option long_options[] = {{"help", no_argument, NULL, 'h'},
+                                  {"count", no_argument, NULL, 'c'},
+                                  {NULL, 0, NULL, 0}};
+
+  count = false;
+  memset(counts, 0, sizeof(counts));
+
+  while ((option = getopt_long(argc, argv, short_options, long_options,
+                               NULL)) != -1) {
+    switch (option) {
+    case 'h':
+      othello_journal_print_help();
+      return EXIT_SUCCESS;
+    case 'c':
+      count = true;
+      break;
+    default:
+      othello_journal_print_help();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (optind == argc) {
+    othello_journal_print_help();
+    return EXIT_FAILURE;
+  }
+
+  for (; optind < argc; optind++) {
+    if (othello_journal_scan(argv[optind], count, counts) < 0) {
+      perror(argv[optind]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (count) {
+    for (event = OTHELLO_JOURNAL_LOGIN; event <= OTHELLO_JOURNAL_GAME_END;
+         event++) {
+      printf("%s %lu\n", othello_journal_event_name(event), counts[event]);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
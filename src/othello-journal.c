@@ -0,0 +1,171 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-journal.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * mapping of a segment file, kept until every record of the segment is written
+ */
+struct othello_journal_segment_s {
+  othello_journal_segment_t *previous; /*never freed, walked back by the late
+                                         writers*/
+  othello_journal_record_t *records;
+  uint64_t first;       /*journal index of the first record*/
+  unsigned int number;  /*suffix of the file*/
+  unsigned int written; /*records copied, the last writer unmaps the segment*/
+};
+
+static char *othello_journal_prefix;
+static unsigned int othello_journal_segment_length;
+static uint64_t othello_journal_next; /*next journal index to reserve*/
+static othello_journal_segment_t *othello_journal_current; /*NULL if disabled*/
+
+static const char *othello_journal_event_names[] = {
+    "none",      "login",      "logoff", "room_join", "room_leave", "ready",
+    "not_ready", "game_start", "play",   "give_up",   "game_end"};
+
+/**
+ * the file is sized at once so the records are written through the mapping
+ * only
+ */
+static othello_journal_segment_t *
+othello_journal_segment_new(othello_journal_segment_t *previous,
+                            uint64_t first) {
+  othello_journal_segment_t *segment;
+  char path[4096];
+  size_t length;
+  int fd;
+
+  if ((segment = calloc(1, sizeof(othello_journal_segment_t))) == NULL) {
+    return NULL;
+  }
+  segment->previous = previous;
+  segment->first = first;
+  segment->number = previous == NULL ? 0 : previous->number + 1;
+
+  length = (size_t)othello_journal_segment_length *
+           sizeof(othello_journal_record_t);
+  snprintf(path, sizeof(path), "%s.%06u", othello_journal_prefix,
+           segment->number);
+
+  if ((fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0) {
+    free(segment);
+    return NULL;
+  }
+  if (ftruncate(fd, length) < 0 ||
+      (segment->records = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    close(fd);
+    free(segment);
+    return NULL;
+  }
+  close(fd);
+
+  return segment;
+}
+
+/**
+ *
+ */
+int othello_journal_init(const char *prefix, unsigned int segment_length) {
+  othello_journal_segment_t *segment;
+
+  if ((othello_journal_prefix = strdup(prefix)) == NULL) {
+    return -1;
+  }
+  othello_journal_segment_length = segment_length;
+  othello_journal_next = 0;
+
+  if ((segment = othello_journal_segment_new(NULL, 0)) == NULL) {
+    return -1;
+  }
+  __atomic_store_n(&othello_journal_current, segment, __ATOMIC_RELEASE);
+
+  return 0;
+}
+
+/**
+ * the writer reserving the first index past the current segment creates the
+ * next one, the writers reserving the following indexes wait for it
+ */
+void othello_journal_append(othello_journal_event_t event, unsigned int player,
+                            unsigned short room, unsigned char value,
+                            const char *name) {
+  othello_journal_segment_t *segment;
+  othello_journal_record_t *record;
+  struct timespec now;
+  uint64_t index;
+
+  if (__atomic_load_n(&othello_journal_current, __ATOMIC_RELAXED) == NULL) {
+    return;
+  }
+
+  clock_gettime(CLOCK_REALTIME, &now);
+  index = __atomic_fetch_add(&othello_journal_next, 1, __ATOMIC_RELAXED);
+
+  for (;;) {
+    if ((segment = __atomic_load_n(&othello_journal_current,
+                                   __ATOMIC_ACQUIRE)) == NULL) {
+      return;
+    }
+    if (index < segment->first + othello_journal_segment_length) {
+      break;
+    }
+    if (index == segment->first + othello_journal_segment_length) {
+      /*the journal is disabled if the next file cannot be created*/
+      segment = othello_journal_segment_new(segment, index);
+      __atomic_store_n(&othello_journal_current, segment, __ATOMIC_RELEASE);
+      if (segment == NULL) {
+        return;
+      }
+      break;
+    }
+    sched_yield();
+  }
+
+  while (index < segment->first) {
+    segment = segment->previous;
+  }
+
+  record = segment->records + (index - segment->first);
+  record->time = (uint64_t)now.tv_sec * UINT64_C(1000000000) + now.tv_nsec;
+  record->player = player;
+  record->room = room;
+  record->value = value;
+  if (name != NULL) {
+    memcpy(record->name, name, OTHELLO_PLAYER_NAME_LENGTH);
+  }
+  /*the event is written last, a record without one is not complete*/
+  __atomic_store_n(&(record->event), event, __ATOMIC_RELEASE);
+
+  if (__atomic_add_fetch(&(segment->written), 1, __ATOMIC_ACQ_REL) ==
+      othello_journal_segment_length) {
+    munmap(segment->records, (size_t)othello_journal_segment_length *
+                                 sizeof(othello_journal_record_t));
+  }
+}
+
+/**
+ *
+ */
+const char *othello_journal_event_name(othello_journal_event_t event) {
+  if (event >= sizeof(othello_journal_event_names) /
+                   sizeof(othello_journal_event_names[0])) {
+    return "unknown";
+  }
+
+  return othello_journal_event_names[event];
+}
@@ -0,0 +1,79 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_JOURNAL_H
+#define OTHELLO_JOURNAL_H
+
+#include "othello.h"
+
+#include <stdint.h>
+
+#define OTHELLO_JOURNAL_DEFAULT_SEGMENT_LENGTH 1048576 /*records per file*/
+/*room of a record outside of a room, the ids are below this one*/
+#define OTHELLO_JOURNAL_NO_ROOM OTHELLO_MAX_NUMBER_OF_ROOMS
+
+enum othello_journal_event_e {
+  OTHELLO_JOURNAL_NONE, /*record not written yet*/
+  OTHELLO_JOURNAL_LOGIN,
+  OTHELLO_JOURNAL_LOGOFF,
+  OTHELLO_JOURNAL_ROOM_JOIN,
+  OTHELLO_JOURNAL_ROOM_LEAVE,
+  OTHELLO_JOURNAL_READY,
+  OTHELLO_JOURNAL_NOT_READY,
+  OTHELLO_JOURNAL_GAME_START,
+  OTHELLO_JOURNAL_PLAY,
+  OTHELLO_JOURNAL_GIVE_UP,
+  OTHELLO_JOURNAL_GAME_END
+};
+
+typedef enum othello_journal_event_e othello_journal_event_t;
+
+/**
+ * fixed size record in host byte order, a segment file is an array of them
+ */
+struct othello_journal_record_s {
+  uint64_t time;   /*nanoseconds since the epoch*/
+  uint32_t player; /*number of the connection*/
+  uint16_t room;   /*id of the room, OTHELLO_JOURNAL_NO_ROOM outside of one*/
+  uint8_t event;   /*othello_journal_event_t*/
+  uint8_t value;   /*square of a play (x * 8 + y), side of the winner*/
+  char name[OTHELLO_PLAYER_NAME_LENGTH]; /*not necessarily a null-terminated
+                                            byte string*/
+};
+
+typedef struct othello_journal_record_s othello_journal_record_t;
+
+struct othello_journal_segment_s;
+
+typedef struct othello_journal_segment_s othello_journal_segment_t;
+
+/**
+ * create the first segment file, the journal is disabled until then
+ * \param prefix path of the segment files, followed by their number
+ * \param segment_length count of records per segment file
+ * \return a negative value on failure
+ */
+int othello_journal_init(const char *prefix, unsigned int segment_length);
+
+/**
+ * append a record, safe to call from any thread without a lock, does nothing
+ * if the journal is disabled
+ * \param event kind of event
+ * \param player number of the connection
+ * \param room id of the room, OTHELLO_JOURNAL_NO_ROOM outside of a room
+ * \param value square of a play, side of the winner
+ * \param name name of the player, NULL if there is none
+ */
+void othello_journal_append(othello_journal_event_t event, unsigned int player,
+                            unsigned short room, unsigned char value,
+                            const char *name);
+
+/**
+ * name of an event
+ * \param event kind of event
+ * \return "unknown" if the event does not exist
+ */
+const char *othello_journal_event_name(othello_journal_event_t event);
+
+#endif
@@ -0,0 +1,853 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello.h"
+#include "othello-board.h"
+#include "othello-histogram.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#define OTHELLO_LOADGEN_DEFAULT_PLAYERS                                        \
+  (OTHELLO_ROOM_LENGTH * OTHELLO_DEFAULT_NUMBER_OF_ROOMS)
+#define OTHELLO_LOADGEN_DEFAULT_WORKERS 2
+#define OTHELLO_LOADGEN_DEFAULT_DURATION 10 /*seconds*/
+#define OTHELLO_LOADGEN_INPUT_LENGTH 4096   /*above a full room list reply*/
+#define OTHELLO_LOADGEN_DEFAULT_BURST 8
+#define OTHELLO_LOADGEN_MAX_BURST 16
+/*a burst of messages sent with the join query*/
+#define OTHELLO_LOADGEN_OUTPUT_LENGTH                                          \
+  (64 + OTHELLO_LOADGEN_MAX_BURST *                                            \
+            (OTHELLO_FRAME_HEADER_LENGTH + 1 + OTHELLO_MESSAGE_LENGTH))
+#define OTHELLO_LOADGEN_EVENTS_LENGTH 256
+#define OTHELLO_LOADGEN_TICK 100 /*milliseconds between deadline checks*/
+#define OTHELLO_LOADGEN_QUERIES (OTHELLO_QUERY_LOBBY + 1)
+#define OTHELLO_LOADGEN_NO_QUERY -1
+
+/**
+ * a simulated player, owned by one worker
+ */
+struct othello_loadgen_player_s {
+  int socket;
+  unsigned int number;
+  unsigned short room;     /*room to join, the next one if it is full*/
+  unsigned int rooms_tried;
+  char input[OTHELLO_LOADGEN_INPUT_LENGTH];
+  size_t input_length;
+  char output[OTHELLO_LOADGEN_OUTPUT_LENGTH];
+  size_t output_length;
+  bool output_polled; /*waiting for EPOLLOUT*/
+  int pending;        /*query waiting for its reply*/
+  int burst;          /*messages of the burst waiting for their reply*/
+  bool joined;        /*the last join succeeded*/
+  struct timespec sent; /*when the pending query was sent*/
+  othello_board_t board;
+  int side;   /*side of the player in the current game*/
+  int square; /*stroke waiting for its reply*/
+  unsigned int seed;
+  bool closed;
+};
+
+typedef struct othello_loadgen_player_s othello_loadgen_player_t;
+
+/**
+ * event loop of a share of the players, its statistics are merged once it is
+ * over
+ */
+struct othello_loadgen_worker_s {
+  pthread_t thread;
+  int event_fd;
+  othello_loadgen_player_t **players;
+  size_t players_count;
+  othello_histogram_t latencies[OTHELLO_LOADGEN_QUERIES]; /*nanoseconds*/
+  unsigned long failures[OTHELLO_LOADGEN_QUERIES];
+  unsigned long games;
+  unsigned long disconnections;
+  unsigned long bursts;          /*bursts fully answered*/
+  unsigned long bursts_failures; /*players disconnected during a burst*/
+};
+
+typedef struct othello_loadgen_worker_s othello_loadgen_worker_t;
+
+static struct sockaddr_in othello_loadgen_address;
+static unsigned int othello_loadgen_rooms;
+static int othello_loadgen_burst;
+static struct timespec othello_loadgen_deadline;
+
+/**
+ *
+ */
+static uint64_t othello_loadgen_elapsed(const struct timespec *start,
+                                        const struct timespec *end) {
+  return (uint64_t)(end->tv_sec - start->tv_sec) * UINT64_C(1000000000) +
+         end->tv_nsec - start->tv_nsec;
+}
+
+/**
+ *
+ */
+static const char *othello_loadgen_query_name(int query) {
+  switch (query) {
+  case OTHELLO_QUERY_LOGIN:
+    return "login";
+  case OTHELLO_QUERY_LOGOFF:
+    return "logoff";
+  case OTHELLO_QUERY_ROOM_LIST:
+    return "room_list";
+  case OTHELLO_QUERY_ROOM_JOIN:
+    return "room_join";
+  case OTHELLO_QUERY_ROOM_LEAVE:
+    return "room_leave";
+  case OTHELLO_QUERY_MESSAGE:
+    return "message";
+  case OTHELLO_QUERY_READY:
+    return "ready";
+  case OTHELLO_QUERY_NOT_READY:
+    return "not_ready";
+  case OTHELLO_QUERY_PLAY:
+    return "play";
+  case OTHELLO_QUERY_GIVE_UP:
+    return "give_up";
+  case OTHELLO_QUERY_LOBBY:
+    return "lobby";
+  default:
+    return "unknown";
+  }
+}
+
+/**
+ * \return the length of the frame at the beginning of buf, 0 if it is not
+ * complete, -1 if the frame is unknown
+ */
+static ssize_t othello_loadgen_frame_length(const char *buf, size_t length) {
+  size_t offset;
+  int rooms_count, players_count;
+
+  if (length == 0) {
+    return 0;
+  }
+
+  switch (buf[0]) {
+  case OTHELLO_QUERY_LOGIN:
+  case OTHELLO_QUERY_ROOM_JOIN:
+  case OTHELLO_QUERY_ROOM_LEAVE:
+  case OTHELLO_QUERY_MESSAGE:
+  case OTHELLO_QUERY_READY:
+  case OTHELLO_QUERY_NOT_READY:
+  case OTHELLO_QUERY_PLAY:
+  case OTHELLO_QUERY_GIVE_UP:
+  case OTHELLO_QUERY_LOBBY:
+    return length >= 2 ? 2 : 0;
+  case OTHELLO_QUERY_ROOM_LIST:
+    /*count of rooms of the server and count of rooms listed, then each room
+      with its id, its count of players and the length and name of each*/
+    offset = 2 + OTHELLO_ROOM_ID_LENGTH;
+    if (length < offset) {
+      return 0;
+    }
+    for (rooms_count = (unsigned char)buf[1 + OTHELLO_ROOM_ID_LENGTH];
+         rooms_count > 0; rooms_count--) {
+      if (length < offset + OTHELLO_ROOM_ID_LENGTH + 1) {
+        return 0;
+      }
+      players_count = (unsigned char)buf[offset + OTHELLO_ROOM_ID_LENGTH];
+      offset += OTHELLO_ROOM_ID_LENGTH + 1;
+      for (; players_count > 0; players_count--) {
+        if (length < offset + 1) {
+          return 0;
+        }
+        offset += 1 + (unsigned char)buf[offset];
+      }
+    }
+    return length >= offset ? (ssize_t)offset : 0;
+  case OTHELLO_NOTIF_ROOM_JOIN:
+  case OTHELLO_NOTIF_ROOM_LEAVE:
+  case OTHELLO_NOTIF_READY:
+  case OTHELLO_NOTIF_NOT_READY:
+  case OTHELLO_NOTIF_GIVE_UP:
+    offset = 1 + OTHELLO_PLAYER_NAME_LENGTH;
+    break;
+  case OTHELLO_NOTIF_MESSAGE:
+    offset = 1 + OTHELLO_PLAYER_NAME_LENGTH + OTHELLO_MESSAGE_LENGTH;
+    break;
+  case OTHELLO_NOTIF_PLAY:
+    offset = 3;
+    break;
+  case OTHELLO_NOTIF_YOUR_TURN:
+    offset = 1;
+    break;
+  case OTHELLO_NOTIF_GAME_START:
+    offset = 2;
+    break;
+  case OTHELLO_NOTIF_GAME_END:
+    offset = 4;
+    break;
+  case OTHELLO_NOTIF_LOBBY:
+    offset = 2 + OTHELLO_ROOM_ID_LENGTH + OTHELLO_PLAYER_NAME_LENGTH;
+    break;
+  default:
+    return -1;
+  }
+
+  return length >= offset ? (ssize_t)offset : 0;
+}
+
+/**
+ * send the queued bytes until the socket would block
+ * \return false on a socket error
+ */
+static bool othello_loadgen_flush(othello_loadgen_worker_t *worker,
+                                  othello_loadgen_player_t *player) {
+  struct epoll_event event;
+  ssize_t sent;
+  bool polled;
+
+  while (player->output_length > 0) {
+    if ((sent = send(player->socket, player->output, player->output_length,
+                     MSG_NOSIGNAL)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        return false;
+      }
+      break;
+    }
+    player->output_length -= sent;
+    memmove(player->output, player->output + sent, player->output_length);
+  }
+
+  polled = player->output_length > 0;
+  if (polled != player->output_polled) {
+    event.events = EPOLLIN | (polled ? EPOLLOUT : 0);
+    event.data.ptr = player;
+    if (epoll_ctl(worker->event_fd, EPOLL_CTL_MOD, player->socket, &event) <
+        0) {
+      return false;
+    }
+    player->output_polled = polled;
+  }
+
+  return true;
+}
+
+/**
+ * the latency of a query is measured from here until its reply is handled
+ */
+static bool othello_loadgen_send(othello_loadgen_worker_t *worker,
+                                 othello_loadgen_player_t *player,
+                                 const char *query, size_t length) {
+  player->pending = query[0];
+  clock_gettime(CLOCK_MONOTONIC, &(player->sent));
+  /*the login query is the only one not framed*/
+  if (query[0] != OTHELLO_QUERY_LOGIN) {
+    OTHELLO_FRAME_LENGTH_SET(player->output + player->output_length, length);
+    player->output_length += OTHELLO_FRAME_HEADER_LENGTH;
+  }
+  memcpy(player->output + player->output_length, query, length);
+  player->output_length += length;
+
+  return othello_loadgen_flush(worker, player);
+}
+
+/**
+ *
+ */
+static bool othello_loadgen_login(othello_loadgen_worker_t *worker,
+                                  othello_loadgen_player_t *player) {
+  char query[2 + OTHELLO_PLAYER_NAME_LENGTH];
+
+  memset(query, 0, sizeof(query));
+  query[0] = OTHELLO_QUERY_LOGIN;
+  query[1] = OTHELLO_PROTOCOL_VERSION;
+  snprintf(query + 2, OTHELLO_PLAYER_NAME_LENGTH, "loadgen%u",
+           player->number);
+
+  return othello_loadgen_send(worker, player, query, sizeof(query));
+}
+
+/**
+ *
+ */
+static bool othello_loadgen_room_list(othello_loadgen_worker_t *worker,
+                                      othello_loadgen_player_t *player) {
+  char query[1 + OTHELLO_ROOM_ID_LENGTH];
+
+  query[0] = OTHELLO_QUERY_ROOM_LIST;
+  OTHELLO_ROOM_ID_SET(query + 1, 0);
+
+  return othello_loadgen_send(worker, player, query, sizeof(query));
+}
+
+/**
+ * the join is followed in the same send by a burst of messages, the server
+ * must answer each of them whatever its backend, even when the join moves the
+ * player to another thread, the latency of each one is measured from the send
+ */
+static bool othello_loadgen_room_join(othello_loadgen_worker_t *worker,
+                                      othello_loadgen_player_t *player) {
+  char *frame;
+  int message;
+
+  frame = player->output + player->output_length;
+  OTHELLO_FRAME_LENGTH_SET(frame, 1 + OTHELLO_ROOM_ID_LENGTH);
+  frame[OTHELLO_FRAME_HEADER_LENGTH] = OTHELLO_QUERY_ROOM_JOIN;
+  OTHELLO_ROOM_ID_SET(frame + OTHELLO_FRAME_HEADER_LENGTH + 1, player->room);
+  player->output_length +=
+      OTHELLO_FRAME_HEADER_LENGTH + 1 + OTHELLO_ROOM_ID_LENGTH;
+
+  for (message = 0; message < othello_loadgen_burst; message++) {
+    frame = player->output + player->output_length;
+    OTHELLO_FRAME_LENGTH_SET(frame, 1 + OTHELLO_MESSAGE_LENGTH);
+    frame[OTHELLO_FRAME_HEADER_LENGTH] = OTHELLO_QUERY_MESSAGE;
+    memset(frame + OTHELLO_FRAME_HEADER_LENGTH + 1, 0, OTHELLO_MESSAGE_LENGTH);
+    snprintf(frame + OTHELLO_FRAME_HEADER_LENGTH + 1, OTHELLO_MESSAGE_LENGTH,
+             "message %d of loadgen%u", message, player->number);
+    player->output_length +=
+        OTHELLO_FRAME_HEADER_LENGTH + 1 + OTHELLO_MESSAGE_LENGTH;
+  }
+
+  player->pending = OTHELLO_QUERY_ROOM_JOIN;
+  player->burst = othello_loadgen_burst;
+  clock_gettime(CLOCK_MONOTONIC, &(player->sent));
+
+  return othello_loadgen_flush(worker, player);
+}
+
+/**
+ *
+ */
+static bool othello_loadgen_ready(othello_loadgen_worker_t *worker,
+                                  othello_loadgen_player_t *player) {
+  char query;
+
+  query = OTHELLO_QUERY_READY;
+
+  return othello_loadgen_send(worker, player, &query, sizeof(query));
+}
+
+/**
+ * once a join and its burst are answered, the player is ready or tries the
+ * next room, it waits once every room was tried
+ */
+static bool othello_loadgen_joined(othello_loadgen_worker_t *worker,
+                                   othello_loadgen_player_t *player) {
+  if (player->joined) {
+    return othello_loadgen_ready(worker, player);
+  }
+  if (++(player->rooms_tried) < othello_loadgen_rooms) {
+    player->room = (player->room + 1) % othello_loadgen_rooms;
+    return othello_loadgen_room_join(worker, player);
+  }
+
+  return true;
+}
+
+/**
+ * a random legal stroke, the server passes the turn of a player without any
+ */
+static bool othello_loadgen_play(othello_loadgen_worker_t *worker,
+                                 othello_loadgen_player_t *player) {
+  othello_bitboard_t moves;
+  char query[3];
+  int skip;
+
+  if ((moves = othello_board_moves(&(player->board), player->side)) == 0) {
+    return true;
+  }
+  for (skip = rand_r(&(player->seed)) % othello_bitboard_count(moves);
+       skip > 0; skip--) {
+    moves &= moves - 1;
+  }
+  player->square = __builtin_ctzll(moves);
+
+  query[0] = OTHELLO_QUERY_PLAY;
+  query[1] = player->square / OTHELLO_BOARD_LENGTH;
+  query[2] = player->square % OTHELLO_BOARD_LENGTH;
+
+  return othello_loadgen_send(worker, player, query, sizeof(query));
+}
+
+/**
+ * a player logs in, lists the rooms, joins a room and is ready, then plays
+ * every game of the room
+ * \return false if the player must be disconnected
+ */
+static bool othello_loadgen_handle(othello_loadgen_worker_t *worker,
+                                   othello_loadgen_player_t *player,
+                                   const char *frame) {
+  struct timespec now;
+
+  /*a reply has the type of its query, the notifications have their own*/
+  if (frame[0] == player->pending) {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    othello_histogram_record(worker->latencies + player->pending,
+                             othello_loadgen_elapsed(&(player->sent), &now));
+    if (frame[0] == OTHELLO_QUERY_ROOM_JOIN && player->burst > 0) {
+      /*the replies of the burst follow the one of the join*/
+      player->pending = OTHELLO_QUERY_MESSAGE;
+    } else if (frame[0] != OTHELLO_QUERY_MESSAGE || --(player->burst) == 0) {
+      player->pending = OTHELLO_LOADGEN_NO_QUERY;
+    }
+    /*the messages after a failed join fail as well*/
+    if (frame[0] != OTHELLO_QUERY_ROOM_LIST && frame[1] != OTHELLO_SUCCESS &&
+        (frame[0] != OTHELLO_QUERY_MESSAGE || player->joined)) {
+      worker->failures[(int)frame[0]]++;
+    }
+  }
+
+  switch (frame[0]) {
+  case OTHELLO_QUERY_LOGIN:
+    return frame[1] == OTHELLO_SUCCESS &&
+           othello_loadgen_room_list(worker, player);
+  case OTHELLO_QUERY_ROOM_LIST:
+    return othello_loadgen_room_join(worker, player);
+  case OTHELLO_QUERY_ROOM_JOIN:
+    /*a full room is left for the next one*/
+    player->joined = frame[1] == OTHELLO_SUCCESS;
+    return player->burst > 0 || othello_loadgen_joined(worker, player);
+  case OTHELLO_QUERY_MESSAGE:
+    if (player->burst > 0) {
+      return true;
+    }
+    worker->bursts++;
+    return othello_loadgen_joined(worker, player);
+  case OTHELLO_QUERY_PLAY:
+    if (frame[1] == OTHELLO_SUCCESS) {
+      othello_board_play(&(player->board), player->side, player->square);
+    }
+    return true;
+  case OTHELLO_NOTIF_PLAY:
+    othello_board_play(&(player->board), !player->side,
+                       OTHELLO_BOARD_SQUARE(frame[1], frame[2]));
+    return true;
+  case OTHELLO_NOTIF_GAME_START:
+    othello_board_init(&(player->board));
+    player->side = frame[1] ? OTHELLO_BOARD_BLACK : OTHELLO_BOARD_WHITE;
+    return !frame[1] || othello_loadgen_play(worker, player);
+  case OTHELLO_NOTIF_YOUR_TURN:
+    return othello_loadgen_play(worker, player);
+  case OTHELLO_NOTIF_GAME_END:
+    /*both players of the game receive it, the black one counts it*/
+    if (player->side == OTHELLO_BOARD_BLACK) {
+      worker->games++;
+    }
+    return othello_loadgen_ready(worker, player);
+  case OTHELLO_NOTIF_GIVE_UP:
+    return othello_loadgen_ready(worker, player);
+  default:
+    return true;
+  }
+}
+
+/**
+ * read until the socket would block and handle every complete frame
+ * \return false if the player must be disconnected
+ */
+static bool othello_loadgen_receive(othello_loadgen_worker_t *worker,
+                                    othello_loadgen_player_t *player) {
+  ssize_t received, length;
+  size_t offset;
+
+  for (;;) {
+    received = recv(player->socket, player->input + player->input_length,
+                    sizeof(player->input) - player->input_length, 0);
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    if (received == 0) {
+      return false;
+    }
+    player->input_length += received;
+
+    offset = 0;
+    while ((length = othello_loadgen_frame_length(
+                player->input + offset, player->input_length - offset)) > 0) {
+      if (!othello_loadgen_handle(worker, player, player->input + offset)) {
+        return false;
+      }
+      offset += length;
+    }
+    if (length < 0) {
+      return false;
+    }
+    player->input_length -= offset;
+    memmove(player->input, player->input + offset, player->input_length);
+  }
+}
+
+/**
+ *
+ */
+static void othello_loadgen_close(othello_loadgen_worker_t *worker,
+                                  othello_loadgen_player_t *player) {
+  if (!player->closed) {
+    player->closed = true;
+    close(player->socket);
+    worker->disconnections++;
+    if (player->burst > 0) {
+      worker->bursts_failures++;
+    }
+  }
+}
+
+/**
+ *
+ */
+static void *othello_loadgen_worker_start(void *arg) {
+  othello_loadgen_worker_t *worker;
+  othello_loadgen_player_t *player;
+  struct epoll_event events[OTHELLO_LOADGEN_EVENTS_LENGTH];
+  struct epoll_event *event_cursor;
+  struct timespec now;
+  size_t i;
+  int events_count;
+
+  worker = (othello_loadgen_worker_t *)arg;
+
+  for (i = 0; i < worker->players_count; i++) {
+    if (!othello_loadgen_login(worker, worker->players[i])) {
+      othello_loadgen_close(worker, worker->players[i]);
+    }
+  }
+
+  for (;;) {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > othello_loadgen_deadline.tv_sec ||
+        (now.tv_sec == othello_loadgen_deadline.tv_sec &&
+         now.tv_nsec >= othello_loadgen_deadline.tv_nsec)) {
+      break;
+    }
+
+    if ((events_count = epoll_wait(worker->event_fd, events,
+                                   OTHELLO_LOADGEN_EVENTS_LENGTH,
+                                   OTHELLO_LOADGEN_TICK)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    for (event_cursor = events; event_cursor < events + events_count;
+         event_cursor++) {
+      player = event_cursor->data.ptr;
+      if (player->closed) {
+        continue;
+      }
+      if (((event_cursor->events & EPOLLOUT) &&
+           !othello_loadgen_flush(worker, player)) ||
+          ((event_cursor->events & (EPOLLIN | EPOLLERR | EPOLLHUP)) &&
+           !othello_loadgen_receive(worker, player))) {
+        othello_loadgen_close(worker, player);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * connect a player, the connections are made before the load starts
+ */
+static othello_loadgen_player_t *
+othello_loadgen_connect(othello_loadgen_worker_t *worker,
+                        unsigned int number) {
+  othello_loadgen_player_t *player;
+  struct epoll_event event;
+  int optval;
+
+  if ((player = calloc(1, sizeof(othello_loadgen_player_t))) == NULL) {
+    return NULL;
+  }
+  player->number = number;
+  player->room = (number / OTHELLO_ROOM_LENGTH) % othello_loadgen_rooms;
+  player->pending = OTHELLO_LOADGEN_NO_QUERY;
+  player->seed = number;
+
+  if ((player->socket = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+    free(player);
+    return NULL;
+  }
+  optval = 1;
+  if (connect(player->socket, (struct sockaddr *)&othello_loadgen_address,
+              sizeof(othello_loadgen_address)) < 0 ||
+      setsockopt(player->socket, IPPROTO_TCP, TCP_NODELAY, &optval,
+                 sizeof(optval)) < 0 ||
+      fcntl(player->socket, F_SETFL,
+            fcntl(player->socket, F_GETFL) | O_NONBLOCK) < 0) {
+    close(player->socket);
+    free(player);
+    return NULL;
+  }
+
+  event.events = EPOLLIN;
+  event.data.ptr = player;
+  if (epoll_ctl(worker->event_fd, EPOLL_CTL_ADD, player->socket, &event) < 0) {
+    close(player->socket);
+    free(player);
+    return NULL;
+  }
+
+  return player;
+}
+
+/**
+ * \return count of players disconnected during a burst
+ */
+static unsigned long othello_loadgen_report(othello_loadgen_worker_t *workers,
+                                   int workers_count, unsigned int players,
+                                   uint64_t duration) {
+  othello_histogram_t latency;
+  unsigned long failures, games, disconnections, bursts, bursts_failures;
+  double seconds;
+  int query, worker;
+
+  seconds = duration / 1e9;
+  games = 0;
+  disconnections = 0;
+  bursts = 0;
+  bursts_failures = 0;
+  for (worker = 0; worker < workers_count; worker++) {
+    games += workers[worker].games;
+    disconnections += workers[worker].disconnections;
+    bursts += workers[worker].bursts;
+    bursts_failures += workers[worker].bursts_failures;
+  }
+
+  printf("%u players, %d workers, %.1f s, %lu games (%.1f per s), %lu "
+         "disconnections\n",
+         players, workers_count, seconds, games, games / seconds,
+         disconnections);
+  printf("bursts of %d pipelined messages: %lu answered, %lu disconnected\n",
+         othello_loadgen_burst, bursts, bursts_failures);
+  printf("%-10s %10s %10s %9s %9s %9s %9s %9s %8s\n", "query", "count",
+         "per s", "p50 us", "p90 us", "p99 us", "p999 us", "max us", "failed");
+
+  for (query = 0; query < OTHELLO_LOADGEN_QUERIES; query++) {
+    othello_histogram_init(&latency);
+    failures = 0;
+    for (worker = 0; worker < workers_count; worker++) {
+      othello_histogram_merge(&latency, workers[worker].latencies + query);
+      failures += workers[worker].failures[query];
+    }
+    if (latency.count == 0) {
+      continue;
+    }
+
+    printf("%-10s %10lu %10.1f %9.1f %9.1f %9.1f %9.1f %9.1f %8lu\n",
+           othello_loadgen_query_name(query), (unsigned long)latency.count,
+           latency.count / seconds,
+           othello_histogram_percentile(&latency, 0.5) / 1e3,
+           othello_histogram_percentile(&latency, 0.9) / 1e3,
+           othello_histogram_percentile(&latency, 0.99) / 1e3,
+           othello_histogram_percentile(&latency, 0.999) / 1e3,
+           latency.max / 1e3, failures);
+  }
+
+  return bursts_failures;
+}
+
+/**
+ *
+ */
+static void othello_loadgen_print_help(void) {
+  printf("Usage: othello-loadgen [options]\n");
+  printf("  -s, --server <host>      server address (default: localhost)\n");
+  printf("  -p, --port <port>        server port (default: %d)\n",
+         OTHELLO_DEFAULT_PORT);
+  printf("  -c, --players <count>    simulated players (default: %d)\n",
+         OTHELLO_LOADGEN_DEFAULT_PLAYERS);
+  printf("  -r, --rooms <count>      rooms of the server (default: %d)\n",
+         OTHELLO_DEFAULT_NUMBER_OF_ROOMS);
+  printf("  -w, --workers <count>    event loop threads (default: %d)\n",
+         OTHELLO_LOADGEN_DEFAULT_WORKERS);
+  printf("  -d, --duration <s>       length of the run (default: %d)\n",
+         OTHELLO_LOADGEN_DEFAULT_DURATION);
+  printf("  -b, --burst <count>      messages sent with a join, 0-%d "
+         "(default: %d)\n",
+         OTHELLO_LOADGEN_MAX_BURST, OTHELLO_LOADGEN_DEFAULT_BURST);
+}
+
+/**
+ *
+ */
+int main(int argc, char *argv[]) {
+  othello_loadgen_worker_t *workers;
+  othello_loadgen_worker_t *worker_cursor;
+  othello_loadgen_player_t **players;
+  struct hostent *host;
+  struct timespec start, end;
+  struct rlimit limit;
+  char *server;
+  unsigned short port;
+  unsigned int players_count, number;
+  int workers_count, duration, option;
+  char *short_options = "hs:p:c:r:w:d:b:";
+  struct option long_options[] = {{"help", no_argument, NULL, 'h'},
+                                  {"server", required_argument, NULL, 's'},
+                                  {"port", required_argument, NULL, 'p'},
+                                  {"players", required_argument, NULL, 'c'},
+                                  {"rooms", required_argument, NULL, 'r'},
+                                  {"workers", required_argument, NULL, 'w'},
+                                  {"duration", required_argument, NULL, 'd'},
+                                  {"burst", required_argument, NULL, 'b'},
+                                  {NULL, 0, NULL, 0}};
+
+  server = "localhost";
+  port = OTHELLO_DEFAULT_PORT;
+  players_count = OTHELLO_LOADGEN_DEFAULT_PLAYERS;
+  othello_loadgen_rooms = OTHELLO_DEFAULT_NUMBER_OF_ROOMS;
+  workers_count = OTHELLO_LOADGEN_DEFAULT_WORKERS;
+  duration = OTHELLO_LOADGEN_DEFAULT_DURATION;
+  othello_loadgen_burst = OTHELLO_LOADGEN_DEFAULT_BURST;
+
+  while ((option = getopt_long(argc, argv, short_options, long_options,
+                               NULL)) != -1) {
+    switch (option) {
+    case 'h':
+      othello_loadgen_print_help();
+      return EXIT_SUCCESS;
+    case 's':
+      server = optarg;
+      break;
+    case 'p':
+      if (sscanf(optarg, "%hu", &port) == 1) {
+        break;
+      }
+      othello_loadgen_print_help();
+      return EXIT_FAILURE;
+    case 'c':
+      if (sscanf(optarg, "%u", &players_count) == 1 && players_count > 0) {
+        break;
+      }
+      othello_loadgen_print_help();
+      return EXIT_FAILURE;
+    case 'r':
+      if (sscanf(optarg, "%u", &othello_loadgen_rooms) == 1 &&
+          othello_loadgen_rooms > 0 &&
+          othello_loadgen_rooms <= OTHELLO_MAX_NUMBER_OF_ROOMS) {
+        break;
+      }
+      othello_loadgen_print_help();
+      return EXIT_FAILURE;
+    case 'w':
+      if (sscanf(optarg, "%d", &workers_count) == 1 && workers_count > 0) {
+        break;
+      }
+      othello_loadgen_print_help();
+      return EXIT_FAILURE;
+    case 'd':
+      if (sscanf(optarg, "%d", &duration) == 1 && duration > 0) {
+        break;
+      }
+      othello_loadgen_print_help();
+      return EXIT_FAILURE;
+    case 'b':
+      if (sscanf(optarg, "%d", &othello_loadgen_burst) == 1 &&
+          othello_loadgen_burst >= 0 &&
+          othello_loadgen_burst <= OTHELLO_LOADGEN_MAX_BURST) {
+        break;
+      }
+      othello_loadgen_print_help();
+      return EXIT_FAILURE;
+    default:
+      othello_loadgen_print_help();
+      return EXIT_FAILURE;
+    }
+  }
+
+  /*one descriptor per player*/
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  if ((host = gethostbyname(server)) == NULL) {
+    fprintf(stderr, "%s: unknown host\n", server);
+    return EXIT_FAILURE;
+  }
+  memset(&othello_loadgen_address, 0, sizeof(othello_loadgen_address));
+  othello_loadgen_address.sin_family = AF_INET;
+  othello_loadgen_address.sin_port = htons(port);
+  memcpy(&othello_loadgen_address.sin_addr, host->h_addr, host->h_length);
+
+  if ((workers = calloc(workers_count, sizeof(othello_loadgen_worker_t))) ==
+          NULL ||
+      (players = calloc(players_count, sizeof(othello_loadgen_player_t *))) ==
+          NULL) {
+    perror("calloc");
+    return EXIT_FAILURE;
+  }
+
+  for (worker_cursor = workers; worker_cursor < workers + workers_count;
+       worker_cursor++) {
+    if ((worker_cursor->event_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+      perror("epoll_create1");
+      return EXIT_FAILURE;
+    }
+    /*first player of the worker, as chosen below*/
+    worker_cursor->players =
+        players + ((uint64_t)(worker_cursor - workers) * players_count +
+                   workers_count - 1) /
+                      workers_count;
+  }
+
+  /*the players of a room are handled by the same worker as far as possible*/
+  for (number = 0; number < players_count; number++) {
+    worker_cursor = workers + (uint64_t)number * workers_count / players_count;
+    if ((worker_cursor->players[worker_cursor->players_count] =
+             othello_loadgen_connect(worker_cursor, number)) == NULL) {
+      perror("connect");
+      return EXIT_FAILURE;
+    }
+    worker_cursor->players_count++;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  othello_loadgen_deadline = start;
+  othello_loadgen_deadline.tv_sec += duration;
+
+  for (worker_cursor = workers; worker_cursor < workers + workers_count;
+       worker_cursor++) {
+    if (pthread_create(&(worker_cursor->thread), NULL,
+                       othello_loadgen_worker_start, worker_cursor)) {
+      perror("pthread_create");
+      return EXIT_FAILURE;
+    }
+  }
+  for (worker_cursor = workers; worker_cursor < workers + workers_count;
+       worker_cursor++) {
+    pthread_join(worker_cursor->thread, NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  /*a server dropping pipelined queries fails the run*/
+  if (othello_loadgen_report(workers, workers_count, players_count,
+                             othello_loadgen_elapsed(&start, &end)) > 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
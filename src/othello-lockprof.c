@@ -0,0 +1,415 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-lockprof.h"
+#include "othello-log.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * mutex held by a thread, with the site and the time of its lock
+ */
+struct othello_lockprof_held_s {
+  pthread_mutex_t *mutex;
+  othello_lockprof_site_t *site;
+  struct timespec acquired;
+};
+
+typedef struct othello_lockprof_held_s othello_lockprof_held_t;
+
+/**
+ * mutexes held by a thread, nested ones last
+ */
+struct othello_lockprof_thread_s {
+  int depth;
+  othello_lockprof_held_t held[OTHELLO_LOCKPROF_DEPTH];
+};
+
+typedef struct othello_lockprof_thread_s othello_lockprof_thread_t;
+
+/**
+ * statistics of every call site of a kind of mutex
+ */
+struct othello_lockprof_class_s {
+  const char *lock_class;
+  unsigned long sites;
+  uint64_t acquisitions;
+  uint64_t contentions;
+  uint64_t wait;
+  uint64_t wait_max;
+  uint64_t hold;
+  uint64_t hold_max;
+};
+
+typedef struct othello_lockprof_class_s othello_lockprof_class_t;
+
+static othello_lockprof_site_t *othello_lockprof_sites;
+static othello_lockprof_site_t *othello_lockprof_table[OTHELLO_LOCKPROF_SITES];
+static pthread_key_t othello_lockprof_key;
+static pthread_once_t othello_lockprof_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ *
+ */
+static void othello_lockprof_key_create(void) {
+  pthread_key_create(&othello_lockprof_key, free);
+}
+
+/**
+ *
+ */
+static othello_lockprof_thread_t *othello_lockprof_thread(void) {
+  othello_lockprof_thread_t *thread;
+
+  pthread_once(&othello_lockprof_key_once, othello_lockprof_key_create);
+
+  if ((thread = pthread_getspecific(othello_lockprof_key)) != NULL) {
+    return thread;
+  }
+
+  if ((thread = calloc(1, sizeof(othello_lockprof_thread_t))) == NULL) {
+    return NULL;
+  }
+  if (pthread_setspecific(othello_lockprof_key, thread)) {
+    free(thread);
+    return NULL;
+  }
+
+  return thread;
+}
+
+/**
+ *
+ */
+static uint64_t othello_lockprof_elapsed(const struct timespec *start,
+                                         const struct timespec *end) {
+  return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000 +
+         (end->tv_nsec - start->tv_nsec);
+}
+
+/**
+ *
+ */
+static void othello_lockprof_max(uint64_t *max, uint64_t value) {
+  uint64_t current;
+
+  current = __atomic_load_n(max, __ATOMIC_RELAXED);
+  while (value > current &&
+         !__atomic_compare_exchange_n(max, &current, value, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+/**
+ * sites are added to the list once and never removed
+ */
+static void othello_lockprof_register(othello_lockprof_site_t *site) {
+  int registered;
+
+  registered = 0;
+  if (!__atomic_compare_exchange_n(&(site->registered), &registered, 1, false,
+                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    return;
+  }
+
+  site->next = __atomic_load_n(&othello_lockprof_sites, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&othello_lockprof_sites, &(site->next),
+                                      site, true, __ATOMIC_RELEASE,
+                                      __ATOMIC_RELAXED)) {
+  }
+}
+
+/**
+ * an uncontended lock is taken by trylock without reading the clock twice
+ */
+void othello_lockprof_lock(othello_lockprof_site_t *site,
+                           pthread_mutex_t *mutex) {
+  othello_lockprof_thread_t *thread;
+  othello_lockprof_held_t *held;
+  struct timespec start, acquired;
+  uint64_t wait;
+
+  if (!__atomic_load_n(&(site->registered), __ATOMIC_RELAXED)) {
+    othello_lockprof_register(site);
+  }
+
+  if (pthread_mutex_trylock(mutex) == EBUSY) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_mutex_lock(mutex);
+    clock_gettime(CLOCK_MONOTONIC, &acquired);
+    wait = othello_lockprof_elapsed(&start, &acquired);
+    __atomic_add_fetch(&(site->contentions), 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&(site->wait), wait, __ATOMIC_RELAXED);
+    othello_lockprof_max(&(site->wait_max), wait);
+  } else {
+    clock_gettime(CLOCK_MONOTONIC, &acquired);
+  }
+  __atomic_add_fetch(&(site->acquisitions), 1, __ATOMIC_RELAXED);
+
+  /*the hold of a lock nested too deep is not measured*/
+  if ((thread = othello_lockprof_thread()) == NULL ||
+      thread->depth == OTHELLO_LOCKPROF_DEPTH) {
+    return;
+  }
+  held = thread->held + thread->depth++;
+  held->mutex = mutex;
+  held->site = site;
+  held->acquired = acquired;
+}
+
+/**
+ * the sites are found by their line in a table with linear probing, a missing
+ * one is inserted by a compare and swap and never removed
+ */
+static othello_lockprof_site_t *othello_lockprof_site(const char *lock_class,
+                                                      const char *file,
+                                                      int line) {
+  othello_lockprof_site_t *site, *created;
+  unsigned int index, probes;
+
+  created = NULL;
+  index = (unsigned int)line * 2654435761u;
+  for (probes = 0; probes < OTHELLO_LOCKPROF_SITES; probes++, index++) {
+    index &= OTHELLO_LOCKPROF_SITES - 1;
+    site = __atomic_load_n(othello_lockprof_table + index, __ATOMIC_ACQUIRE);
+    if (site == NULL) {
+      if (created == NULL &&
+          (created = calloc(1, sizeof(othello_lockprof_site_t))) == NULL) {
+        return NULL;
+      }
+      created->lock_class = lock_class;
+      created->file = file;
+      created->line = line;
+      if (__atomic_compare_exchange_n(othello_lockprof_table + index, &site,
+                                      created, false, __ATOMIC_ACQ_REL,
+                                      __ATOMIC_ACQUIRE)) {
+        return created;
+      }
+    }
+    if (site->line == line && strcmp(site->file, file) == 0 &&
+        strcmp(site->lock_class, lock_class) == 0) {
+      free(created);
+      return site;
+    }
+  }
+
+  free(created);
+  return NULL;
+}
+
+/**
+ * the mutex is locked without statistics when the table is full
+ */
+void othello_lockprof_lock_at(pthread_mutex_t *mutex, const char *lock_class,
+                              const char *file, int line) {
+  othello_lockprof_site_t *site;
+
+  if ((site = othello_lockprof_site(lock_class, file, line)) == NULL) {
+    pthread_mutex_lock(mutex);
+    return;
+  }
+
+  othello_lockprof_lock(site, mutex);
+}
+
+/**
+ * mutexes are not always unlocked in the reverse order of their locks, the
+ * held one is searched from the last
+ */
+void othello_lockprof_unlock(pthread_mutex_t *mutex) {
+  othello_lockprof_thread_t *thread;
+  othello_lockprof_held_t *held;
+  struct timespec released;
+  uint64_t hold;
+  int index;
+
+  if ((thread = pthread_getspecific(othello_lockprof_key)) != NULL) {
+    for (index = thread->depth - 1;
+         index >= 0 && thread->held[index].mutex != mutex; index--) {
+    }
+    if (index >= 0) {
+      held = thread->held + index;
+      clock_gettime(CLOCK_MONOTONIC, &released);
+      hold = othello_lockprof_elapsed(&(held->acquired), &released);
+      __atomic_add_fetch(&(held->site->hold), hold, __ATOMIC_RELAXED);
+      othello_lockprof_max(&(held->site->hold_max), hold);
+      thread->depth--;
+      memmove(held, held + 1,
+              (thread->depth - index) * sizeof(othello_lockprof_held_t));
+    }
+  }
+
+  pthread_mutex_unlock(mutex);
+}
+
+/**
+ * longest total wait first
+ */
+static int othello_lockprof_compare(const void *a, const void *b) {
+  uint64_t wait_a, wait_b;
+
+  wait_a = __atomic_load_n(&((*(othello_lockprof_site_t *const *)a)->wait),
+                           __ATOMIC_RELAXED);
+  wait_b = __atomic_load_n(&((*(othello_lockprof_site_t *const *)b)->wait),
+                           __ATOMIC_RELAXED);
+
+  return wait_a < wait_b ? 1 : (wait_a > wait_b ? -1 : 0);
+}
+
+/**
+ * add the statistics of the sites to the ones of their class, the classes are
+ * few so they are searched one by one
+ * \return count of classes
+ */
+static size_t othello_lockprof_classes(othello_lockprof_site_t **sites,
+                                       size_t sites_count,
+                                       othello_lockprof_class_t *classes) {
+  othello_lockprof_site_t *site;
+  othello_lockprof_class_t *class;
+  size_t classes_count, index;
+  uint64_t value;
+
+  classes_count = 0;
+  for (index = 0; index < sites_count; index++) {
+    site = sites[index];
+    for (class = classes; class < classes + classes_count &&
+                          strcmp(class->lock_class, site->lock_class) != 0;
+         class++) {
+    }
+    if (class == classes + classes_count) {
+      memset(class, 0, sizeof(othello_lockprof_class_t));
+      class->lock_class = site->lock_class;
+      classes_count++;
+    }
+
+    class->sites++;
+    class->acquisitions +=
+        __atomic_load_n(&(site->acquisitions), __ATOMIC_RELAXED);
+    class->contentions +=
+        __atomic_load_n(&(site->contentions), __ATOMIC_RELAXED);
+    class->wait += __atomic_load_n(&(site->wait), __ATOMIC_RELAXED);
+    class->hold += __atomic_load_n(&(site->hold), __ATOMIC_RELAXED);
+    if ((value = __atomic_load_n(&(site->wait_max), __ATOMIC_RELAXED)) >
+        class->wait_max) {
+      class->wait_max = value;
+    }
+    if ((value = __atomic_load_n(&(site->hold_max), __ATOMIC_RELAXED)) >
+        class->hold_max) {
+      class->hold_max = value;
+    }
+  }
+
+  return classes_count;
+}
+
+/**
+ * counts since the start of the server, a site is read while it is written so
+ * its values may be off by a lock, the totals of each class follow the sites
+ */
+void othello_lockprof_report(int count) {
+  othello_lockprof_site_t *first, *site;
+  othello_lockprof_site_t **sites;
+  othello_lockprof_class_t *classes, *class;
+  size_t sites_count, classes_count, index;
+  uint64_t acquisitions, contentions;
+
+  /*sites are pushed at the head, the list after it never changes*/
+  first = __atomic_load_n(&othello_lockprof_sites, __ATOMIC_ACQUIRE);
+
+  sites_count = 0;
+  for (site = first; site != NULL; site = site->next) {
+    sites_count++;
+  }
+  if (sites_count == 0 ||
+      (sites = malloc(sites_count * sizeof(othello_lockprof_site_t *))) ==
+          NULL) {
+    return;
+  }
+
+  index = 0;
+  for (site = first; site != NULL; site = site->next) {
+    sites[index++] = site;
+  }
+  qsort(sites, sites_count, sizeof(othello_lockprof_site_t *),
+        othello_lockprof_compare);
+
+  othello_log(LOG_NOTICE,
+              "lock profile - top %d of %lu sites: class site acquisitions "
+              "contended wait_ms wait_max_us hold_ms hold_max_us",
+              count, (unsigned long)sites_count);
+  for (index = 0; index < sites_count && (int)index < count; index++) {
+    site = sites[index];
+    acquisitions = __atomic_load_n(&(site->acquisitions), __ATOMIC_RELAXED);
+    contentions = __atomic_load_n(&(site->contentions), __ATOMIC_RELAXED);
+    othello_log(LOG_NOTICE,
+                "lock profile - %s %s:%d %lu %.2f%% %.3f %.1f %.3f %.1f",
+                site->lock_class, site->file, site->line,
+                (unsigned long)acquisitions,
+                acquisitions > 0 ? 100.0 * contentions / acquisitions : 0.0,
+                __atomic_load_n(&(site->wait), __ATOMIC_RELAXED) / 1e6,
+                __atomic_load_n(&(site->wait_max), __ATOMIC_RELAXED) / 1e3,
+                __atomic_load_n(&(site->hold), __ATOMIC_RELAXED) / 1e6,
+                __atomic_load_n(&(site->hold_max), __ATOMIC_RELAXED) / 1e3);
+  }
+
+  /*a class per site at most*/
+  if ((classes = malloc(sites_count * sizeof(othello_lockprof_class_t))) !=
+      NULL) {
+    classes_count = othello_lockprof_classes(sites, sites_count, classes);
+    othello_log(LOG_NOTICE,
+                "lock profile - %lu classes: class sites acquisitions "
+                "contended wait_ms wait_max_us hold_ms hold_max_us",
+                (unsigned long)classes_count);
+    for (class = classes; class < classes + classes_count; class++) {
+      othello_log(LOG_NOTICE,
+                  "lock profile - %s %lu %lu %.2f%% %.3f %.1f %.3f %.1f",
+                  class->lock_class, class->sites,
+                  (unsigned long)class->acquisitions,
+                  class->acquisitions > 0
+                      ? 100.0 * class->contentions / class->acquisitions
+                      : 0.0,
+                  class->wait / 1e6, class->wait_max / 1e3, class->hold / 1e6,
+                  class->hold_max / 1e3);
+    }
+    free(classes);
+  }
+
+  free(sites);
+}
+
+/**
+ *
+ */
+static void *othello_lockprof_start(void *arg) {
+  (void)arg;
+
+  for (;;) {
+    sleep(OTHELLO_LOCKPROF_INTERVAL);
+    othello_lockprof_report(OTHELLO_LOCKPROF_TOP);
+  }
+
+  return NULL;
+}
+
+/**
+ *
+ */
+int othello_lockprof_init(void) {
+  pthread_t thread;
+
+  if (pthread_create(&thread, NULL, othello_lockprof_start, NULL) ||
+      pthread_detach(thread)) {
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_LOCKPROF_H
+#define OTHELLO_LOCKPROF_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#ifndef OTHELLO_LOCKPROF_INTERVAL
+#define OTHELLO_LOCKPROF_INTERVAL 10 /*seconds between two reports*/
+#endif
+#ifndef OTHELLO_LOCKPROF_TOP
+#define OTHELLO_LOCKPROF_TOP 10 /*call sites per report*/
+#endif
+#define OTHELLO_LOCKPROF_DEPTH 8 /*mutexes held at once by a thread*/
+#define OTHELLO_LOCKPROF_SITES 1024 /*sites of othello_lockprof_lock_at, a
+                                       power of 2*/
+
+/**
+ * statistics of the mutex locks of one call site, in nanoseconds, a site is
+ * registered by its first lock
+ */
+struct othello_lockprof_site_s {
+  const char *lock_class; /*kind of mutex, as "room" or "player"*/
+  const char *file;
+  int line;
+  int registered;
+  struct othello_lockprof_site_s *next; /*every site registered*/
+  uint64_t acquisitions;
+  uint64_t contentions; /*locks that had to wait for another thread*/
+  uint64_t wait;
+  uint64_t wait_max;
+  uint64_t hold;
+  uint64_t hold_max;
+};
+
+typedef struct othello_lockprof_site_s othello_lockprof_site_t;
+
+/**
+ * lock a mutex and record the wait at this call site, then the hold until
+ * othello_lockprof_unlock
+ * \param mutex mutex to lock
+ * \param lock_class kind of mutex, a string literal
+ */
+#define OTHELLO_LOCKPROF_LOCK(mutex, lock_class)                              \
+  do {                                                                         \
+    static othello_lockprof_site_t othello_lockprof_site = {lock_class,       \
+                                                            __FILE__,          \
+                                                            __LINE__};         \
+    othello_lockprof_lock(&othello_lockprof_site, (mutex));                   \
+  } while (0)
+
+/**
+ * start the thread writing the report of the most contended call sites to
+ * the log every OTHELLO_LOCKPROF_INTERVAL seconds
+ * \return a negative value on failure
+ */
+int othello_lockprof_init(void);
+
+/**
+ * lock a mutex, use OTHELLO_LOCKPROF_LOCK instead
+ * \param site statistics of the call site
+ * \param mutex mutex to lock
+ */
+void othello_lockprof_lock(othello_lockprof_site_t *site,
+                           pthread_mutex_t *mutex);
+
+/**
+ * lock a mutex and record it at the site of a given file and line, for a lock
+ * taken on behalf of a caller, the site is created by its first lock
+ * \param mutex mutex to lock
+ * \param lock_class kind of mutex, a string literal
+ * \param file file of the caller, a string literal
+ * \param line line of the caller
+ */
+void othello_lockprof_lock_at(pthread_mutex_t *mutex, const char *lock_class,
+                              const char *file, int line);
+
+/**
+ * unlock a mutex locked by othello_lockprof_lock and record its hold time at
+ * the site of the lock
+ * \param mutex mutex to unlock
+ */
+void othello_lockprof_unlock(pthread_mutex_t *mutex);
+
+/**
+ * write the report of the call sites with the longest waits to the log, then
+ * the totals of every call site of each class of mutex
+ * \param count count of call sites
+ */
+void othello_lockprof_report(int count);
+
+#endif
@@ -0,0 +1,354 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-log.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+struct othello_log_record_s {
+  struct timespec time;
+  int priority;
+  char message[OTHELLO_LOG_MESSAGE_LENGTH];
+};
+
+typedef struct othello_log_record_s othello_log_record_t;
+
+/**
+ * single producer single consumer ring, written by its owner thread and read by
+ * the log writer thread
+ */
+struct othello_log_ring_s {
+  othello_log_ring_t *next; /*every ring ever created, never removed*/
+  bool owned;               /*used by a running thread*/
+  unsigned int head;        /*next record to write out, moved by the writer*/
+  char padding[64];         /*head and tail on distinct cache lines*/
+  unsigned int tail;        /*next free record, moved by the owner*/
+  othello_log_record_t records[OTHELLO_LOG_RECORDS];
+};
+
+/**
+ * ring with records to write and its tail when the drain started
+ */
+struct othello_log_pending_s {
+  othello_log_ring_t *ring;
+  unsigned int tail;
+  const struct timespec *time; /*time of the head record of the ring*/
+};
+
+typedef struct othello_log_pending_s othello_log_pending_t;
+
+static othello_log_ring_t *othello_log_rings;
+static pthread_key_t othello_log_key;
+static pthread_once_t othello_log_key_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t othello_log_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool othello_log_syslog;
+static int othello_log_priority = LOG_INFO;
+static unsigned int othello_log_dropped; /*no ring or a full ring, since the
+                                           last drain*/
+static time_t othello_log_date_time;     /*second of the cached date*/
+static char othello_log_date[32];
+static othello_log_pending_t *othello_log_pending; /*rings of the drain, a
+                                                     heap by head record time*/
+static size_t othello_log_pending_capacity;
+
+/**
+ * a thread gives back its ring when it ends, the ring keeps its pending records
+ */
+static void othello_log_ring_put(void *ring) {
+  __atomic_store_n(&(((othello_log_ring_t *)ring)->owned), false,
+                   __ATOMIC_RELEASE);
+}
+
+/**
+ *
+ */
+static void othello_log_key_create(void) {
+  pthread_key_create(&othello_log_key, othello_log_ring_put);
+}
+
+/**
+ * the ring of an ended thread is reused before a new one is allocated, so there
+ * are never more rings than threads running at once
+ */
+static othello_log_ring_t *othello_log_ring_get(void) {
+  othello_log_ring_t *ring;
+  bool owned;
+
+  pthread_once(&othello_log_key_once, othello_log_key_create);
+
+  if ((ring = pthread_getspecific(othello_log_key)) != NULL) {
+    return ring;
+  }
+
+  for (ring = __atomic_load_n(&othello_log_rings, __ATOMIC_ACQUIRE);
+       ring != NULL; ring = ring->next) {
+    owned = false;
+    if (__atomic_compare_exchange_n(&(ring->owned), &owned, true, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+
+  if (ring == NULL) {
+    if ((ring = calloc(1, sizeof(othello_log_ring_t))) == NULL) {
+      return NULL;
+    }
+    ring->owned = true;
+    ring->next = __atomic_load_n(&othello_log_rings, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&othello_log_rings, &(ring->next), ring,
+                                        true, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED)) {
+    }
+  }
+
+  pthread_setspecific(othello_log_key, ring);
+
+  return ring;
+}
+
+/**
+ * the date is formatted once per second
+ */
+static void othello_log_write(time_t time, int priority, const char *message) {
+  struct tm tm;
+
+  if (othello_log_syslog) {
+    syslog(priority, "%s", message);
+    return;
+  }
+
+  if (time != othello_log_date_time || othello_log_date[0] == '\0') {
+    othello_log_date_time = time;
+    memset(othello_log_date, 0, sizeof(othello_log_date));
+    if (localtime_r(&time, &tm) != NULL) {
+      strftime(othello_log_date, sizeof(othello_log_date), "%a %d %H:%M:%S",
+               &tm);
+    }
+  }
+
+  printf("%s othello-server[%d]: %s\n", othello_log_date, getpid(), message);
+}
+
+/**
+ * records of the drain were written before the tail was read
+ */
+static othello_log_record_t *othello_log_pending_head(
+    othello_log_pending_t *pending) {
+  return pending->ring->records +
+         (pending->ring->head & (OTHELLO_LOG_RECORDS - 1));
+}
+
+/**
+ *
+ */
+static bool othello_log_pending_before(const othello_log_pending_t *a,
+                                       const othello_log_pending_t *b) {
+  return a->time->tv_sec < b->time->tv_sec ||
+         (a->time->tv_sec == b->time->tv_sec &&
+          a->time->tv_nsec < b->time->tv_nsec);
+}
+
+/**
+ * move down the ring at a position of the heap until its head record is not
+ * after the ones of its children
+ */
+static void othello_log_pending_sift(size_t index, size_t count) {
+  othello_log_pending_t pending;
+  size_t child;
+
+  pending = othello_log_pending[index];
+  while ((child = 2 * index + 1) < count) {
+    if (child + 1 < count &&
+        othello_log_pending_before(othello_log_pending + child + 1,
+                                   othello_log_pending + child)) {
+      child++;
+    }
+    if (!othello_log_pending_before(othello_log_pending + child, &pending)) {
+      break;
+    }
+    othello_log_pending[index] = othello_log_pending[child];
+    index = child;
+  }
+  othello_log_pending[index] = pending;
+}
+
+/**
+ * the records of the rings are merged by time so the output keeps the order of
+ * the events across threads, the records of a ring are already in order so
+ * only the heads of the rings are compared, a record is only given back to its
+ * ring once written
+ */
+static void othello_log_drain(void) {
+  othello_log_ring_t *ring;
+  othello_log_pending_t *pending;
+  othello_log_record_t *record;
+  size_t pending_count, capacity, index;
+  unsigned int tail, dropped;
+  char message[64];
+
+  /*records written meanwhile wait for the next drain*/
+  pending_count = 0;
+  for (ring = __atomic_load_n(&othello_log_rings, __ATOMIC_ACQUIRE);
+       ring != NULL; ring = ring->next) {
+    if (ring->head == (tail = __atomic_load_n(&(ring->tail),
+                                              __ATOMIC_ACQUIRE))) {
+      continue;
+    }
+    if (pending_count == othello_log_pending_capacity) {
+      capacity = othello_log_pending_capacity * 2 + 16;
+      if ((pending = realloc(othello_log_pending,
+                             capacity * sizeof(othello_log_pending_t))) ==
+          NULL) {
+        break;
+      }
+      othello_log_pending = pending;
+      othello_log_pending_capacity = capacity;
+    }
+    pending = othello_log_pending + pending_count++;
+    pending->ring = ring;
+    pending->tail = tail;
+    pending->time = &(othello_log_pending_head(pending)->time);
+  }
+
+  for (index = pending_count / 2; index > 0; index--) {
+    othello_log_pending_sift(index - 1, pending_count);
+  }
+
+  while (pending_count > 0) {
+    pending = othello_log_pending;
+    record = othello_log_pending_head(pending);
+    othello_log_write(record->time.tv_sec, record->priority, record->message);
+
+    ring = pending->ring;
+    __atomic_store_n(&(ring->head), ring->head + 1, __ATOMIC_RELEASE);
+    if (ring->head == pending->tail) {
+      *pending = othello_log_pending[--pending_count];
+    } else {
+      pending->time = &(othello_log_pending_head(pending)->time);
+    }
+    othello_log_pending_sift(0, pending_count);
+  }
+
+  if ((dropped = __atomic_exchange_n(&othello_log_dropped, 0,
+                                     __ATOMIC_RELAXED)) > 0) {
+    sprintf(message, "log - %u messages dropped", dropped);
+    othello_log_write(time(NULL), LOG_WARNING, message);
+  }
+
+  if (!othello_log_syslog) {
+    fflush(stdout);
+  }
+}
+
+/**
+ *
+ */
+static void *othello_log_start(void *arg) {
+  struct timespec interval;
+
+  interval.tv_sec = OTHELLO_LOG_INTERVAL / 1000;
+  interval.tv_nsec = OTHELLO_LOG_INTERVAL % 1000 * 1000000;
+
+  for (;;) {
+    nanosleep(&interval, NULL);
+    othello_log_flush();
+  }
+
+  return NULL;
+}
+
+/**
+ *
+ */
+int othello_log_init(bool syslog_output, int level) {
+  int status;
+  pthread_t thread;
+
+  othello_log_syslog = syslog_output;
+  othello_log_level_set(level);
+  openlog(NULL, LOG_CONS | LOG_PID, LOG_USER);
+
+  if ((status = pthread_create(&thread, NULL, othello_log_start, NULL)) ||
+      (status = pthread_detach(thread))) {
+    return -status;
+  }
+
+  return 0;
+}
+
+/**
+ * only the filter and the formatting are left on the calling thread, it never
+ * waits for the writer nor writes itself
+ */
+void othello_log(int priority, const char *format, ...) {
+  va_list ap;
+  othello_log_ring_t *ring;
+  othello_log_record_t *record;
+  unsigned int tail;
+
+  if (priority > __atomic_load_n(&othello_log_priority, __ATOMIC_RELAXED)) {
+    return;
+  }
+
+  if ((ring = othello_log_ring_get()) == NULL) {
+    __atomic_add_fetch(&othello_log_dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  /*a burst larger than the ring is dropped and reported by the writer*/
+  if (ring->tail - __atomic_load_n(&(ring->head), __ATOMIC_ACQUIRE) ==
+      OTHELLO_LOG_RECORDS) {
+    __atomic_add_fetch(&othello_log_dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  tail = ring->tail;
+  record = ring->records + (tail & (OTHELLO_LOG_RECORDS - 1));
+  clock_gettime(CLOCK_REALTIME, &(record->time));
+  record->priority = priority;
+
+  va_start(ap, format);
+  vsnprintf(record->message, sizeof(record->message), format, ap);
+  va_end(ap);
+
+  __atomic_store_n(&(ring->tail), tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ *
+ */
+void othello_log_level_set(int level) {
+  if (level < LOG_EMERG) {
+    level = LOG_EMERG;
+  } else if (level > LOG_DEBUG) {
+    level = LOG_DEBUG;
+  }
+
+  __atomic_store_n(&othello_log_priority, level, __ATOMIC_RELAXED);
+}
+
+/**
+ *
+ */
+int othello_log_level(void) {
+  return __atomic_load_n(&othello_log_priority, __ATOMIC_RELAXED);
+}
+
+/**
+ *
+ */
+void othello_log_flush(void) {
+  pthread_mutex_lock(&othello_log_writer_mutex);
+  othello_log_drain();
+  pthread_mutex_unlock(&othello_log_writer_mutex);
+}
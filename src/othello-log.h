@@ -0,0 +1,51 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_LOG_H
+#define OTHELLO_LOG_H
+
+#include <stdbool.h>
+
+#define OTHELLO_LOG_RECORDS 128 /*per thread, must be a power of 2*/
+#define OTHELLO_LOG_MESSAGE_LENGTH 384
+#define OTHELLO_LOG_INTERVAL 10 /*milliseconds between two drains*/
+
+struct othello_log_ring_s;
+
+typedef struct othello_log_ring_s othello_log_ring_t;
+
+/**
+ * start the log writer thread, messages logged before are kept until then
+ * \param syslog_output write to syslog instead of standard output
+ * \param level most verbose priority written (see syslog message level)
+ * \return a negative value on failure
+ */
+int othello_log_init(bool syslog_output, int level);
+
+/**
+ * log a message to standard output or to syslog, the message is formatted in a
+ * ring of the calling thread and written later by the log writer thread, the
+ * message is dropped and counted if the ring is full
+ * \param priority message priority (see syslog message level)
+ * \param format message to log
+ */
+void othello_log(int priority, const char *format, ...);
+
+/**
+ * change the most verbose priority written, safe to call from a signal handler
+ * \param level new priority, clamped to the syslog message levels
+ */
+void othello_log_level_set(int level);
+
+/**
+ * most verbose priority written
+ */
+int othello_log_level(void);
+
+/**
+ * write every pending message from the calling thread
+ */
+void othello_log_flush(void);
+
+#endif
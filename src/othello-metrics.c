@@ -0,0 +1,411 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-metrics.h"
+#include "othello-histogram.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define OTHELLO_METRICS_QUERIES 12 /*queries 0 to 9, lobby then unknown*/
+#define OTHELLO_METRICS_QUERY_LOBBY 10
+#define OTHELLO_METRICS_QUERY_UNKNOWN 11
+#define OTHELLO_METRICS_REQUEST_LENGTH 1024
+#define OTHELLO_METRICS_TIMEOUT 1 /*seconds to read a request*/
+
+/**
+ * written by the threads given this shard, with relaxed atomics so a shard
+ * may be shared and read while it is written
+ */
+struct othello_metrics_shard_s {
+  othello_histogram_t durations[OTHELLO_METRICS_QUERIES]; /*nanoseconds*/
+  uint64_t failures[OTHELLO_METRICS_QUERIES];
+  uint64_t counters[OTHELLO_METRICS_COUNTERS];
+  char padding[64]; /*counters of two shards on distinct cache lines*/
+};
+
+typedef struct othello_metrics_shard_s othello_metrics_shard_t;
+
+/**
+ * state of a thread, found by its key
+ */
+struct othello_metrics_thread_s {
+  othello_metrics_shard_t *shard;
+  const void *player; /*player whose query is handled*/
+};
+
+typedef struct othello_metrics_thread_s othello_metrics_thread_t;
+
+static const char *othello_metrics_query_names[OTHELLO_METRICS_QUERIES] = {
+    "login", "logoff", "room_list", "room_join", "room_leave", "message",
+    "ready", "not_ready", "play",    "give_up",   "lobby",      "unknown"};
+
+static const char *othello_metrics_counter_names[OTHELLO_METRICS_COUNTERS][2] =
+    {{"othello_bytes_received_total", "Bytes read from the players."},
+     {"othello_bytes_sent_total", "Bytes written to the players."},
+     {"othello_broadcasts_total",
+      "Frames sent to another player than the one whose query is handled."}};
+
+static const char *othello_metrics_gauge_names[OTHELLO_METRICS_GAUGES][2] = {
+    {"othello_connections", "Players connected."},
+    {"othello_rooms", "Rooms with at least one player."},
+    {"othello_games", "Games in progress."}};
+
+static const double othello_metrics_quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+static bool othello_metrics_enabled;
+static othello_metrics_shard_t *othello_metrics_shards;
+static unsigned int othello_metrics_shards_next;
+static long othello_metrics_gauges[OTHELLO_METRICS_GAUGES];
+static int othello_metrics_socket;
+static pthread_key_t othello_metrics_key;
+
+/**
+ * a thread is given the next shard when it records its first value
+ */
+static othello_metrics_thread_t *othello_metrics_thread(void) {
+  othello_metrics_thread_t *thread;
+
+  if ((thread = pthread_getspecific(othello_metrics_key)) != NULL) {
+    return thread;
+  }
+
+  if ((thread = calloc(1, sizeof(othello_metrics_thread_t))) == NULL) {
+    return NULL;
+  }
+  thread->shard = othello_metrics_shards +
+                  __atomic_fetch_add(&othello_metrics_shards_next, 1,
+                                     __ATOMIC_RELAXED) %
+                      OTHELLO_METRICS_SHARDS;
+  if (pthread_setspecific(othello_metrics_key, thread)) {
+    free(thread);
+    return NULL;
+  }
+
+  return thread;
+}
+
+/**
+ *
+ */
+static int othello_metrics_query_index(char query) {
+  if (query >= OTHELLO_QUERY_LOGIN && query <= OTHELLO_QUERY_GIVE_UP) {
+    return query - OTHELLO_QUERY_LOGIN;
+  }
+  if (query == OTHELLO_QUERY_LOBBY) {
+    return OTHELLO_METRICS_QUERY_LOBBY;
+  }
+
+  return OTHELLO_METRICS_QUERY_UNKNOWN;
+}
+
+/**
+ *
+ */
+void othello_metrics_query_begin(const void *player, struct timespec *start) {
+  othello_metrics_thread_t *thread;
+
+  if (!othello_metrics_enabled) {
+    return;
+  }
+
+  if ((thread = othello_metrics_thread()) != NULL) {
+    thread->player = player;
+  }
+  clock_gettime(CLOCK_MONOTONIC, start);
+}
+
+/**
+ *
+ */
+void othello_metrics_query_end(char query, const struct timespec *start,
+                               othello_status_t status) {
+  othello_metrics_thread_t *thread;
+  struct timespec end;
+  int index;
+
+  if (!othello_metrics_enabled ||
+      (thread = othello_metrics_thread()) == NULL) {
+    return;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  thread->player = NULL;
+  index = othello_metrics_query_index(query);
+
+  othello_histogram_record_shared(
+      thread->shard->durations + index,
+      (uint64_t)(end.tv_sec - start->tv_sec) * 1000000000 +
+          (end.tv_nsec - start->tv_nsec));
+  if (status != OTHELLO_SUCCESS) {
+    __atomic_add_fetch(thread->shard->failures + index, 1, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ *
+ */
+void othello_metrics_count(othello_metrics_counter_t counter,
+                           uint64_t value) {
+  othello_metrics_thread_t *thread;
+
+  if (!othello_metrics_enabled ||
+      (thread = othello_metrics_thread()) == NULL) {
+    return;
+  }
+
+  __atomic_add_fetch(thread->shard->counters + counter, value,
+                     __ATOMIC_RELAXED);
+}
+
+/**
+ * the lobby and the writer threads never handle a query, their frames are
+ * all broadcasts
+ */
+void othello_metrics_frames(const void *player, int count) {
+  othello_metrics_thread_t *thread;
+
+  if (!othello_metrics_enabled ||
+      (thread = othello_metrics_thread()) == NULL || thread->player == player) {
+    return;
+  }
+
+  __atomic_add_fetch(thread->shard->counters + OTHELLO_METRICS_BROADCASTS,
+                     count, __ATOMIC_RELAXED);
+}
+
+/**
+ *
+ */
+void othello_metrics_gauge(othello_metrics_gauge_t gauge, int delta) {
+  if (!othello_metrics_enabled) {
+    return;
+  }
+
+  __atomic_add_fetch(othello_metrics_gauges + gauge, delta, __ATOMIC_RELAXED);
+}
+
+/**
+ * the shards are merged at each scrape, quantiles are those of the whole
+ * run as in a summary without a sliding window
+ */
+static void othello_metrics_print(FILE *stream) {
+  othello_histogram_t *merged;
+  othello_metrics_shard_t *shard;
+  uint64_t failures[OTHELLO_METRICS_QUERIES];
+  uint64_t counters[OTHELLO_METRICS_COUNTERS];
+  int index, quantile;
+
+  if ((merged = calloc(OTHELLO_METRICS_QUERIES, sizeof(othello_histogram_t))) ==
+      NULL) {
+    return;
+  }
+  memset(failures, 0, sizeof(failures));
+  memset(counters, 0, sizeof(counters));
+
+  for (shard = othello_metrics_shards;
+       shard < othello_metrics_shards + OTHELLO_METRICS_SHARDS; shard++) {
+    for (index = 0; index < OTHELLO_METRICS_QUERIES; index++) {
+      othello_histogram_merge(merged + index, shard->durations + index);
+      failures[index] +=
+          __atomic_load_n(shard->failures + index, __ATOMIC_RELAXED);
+    }
+    for (index = 0; index < OTHELLO_METRICS_COUNTERS; index++) {
+      counters[index] +=
+          __atomic_load_n(shard->counters + index, __ATOMIC_RELAXED);
+    }
+  }
+
+  fprintf(stream, "# HELP othello_query_duration_seconds Time to handle a "
+                  "query.\n"
+                  "# TYPE othello_query_duration_seconds summary\n");
+  for (index = 0; index < OTHELLO_METRICS_QUERIES; index++) {
+    if (merged[index].count == 0) {
+      continue;
+    }
+    for (quantile = 0; quantile < (int)(sizeof(othello_metrics_quantiles) /
+                                        sizeof(double));
+         quantile++) {
+      fprintf(stream,
+              "othello_query_duration_seconds{query=\"%s\",quantile=\"%g\"} "
+              "%.9f\n",
+              othello_metrics_query_names[index],
+              othello_metrics_quantiles[quantile],
+              othello_histogram_percentile(
+                  merged + index, othello_metrics_quantiles[quantile]) /
+                  1e9);
+    }
+    fprintf(stream,
+            "othello_query_duration_seconds_sum{query=\"%s\"} %.9f\n"
+            "othello_query_duration_seconds_count{query=\"%s\"} %lu\n",
+            othello_metrics_query_names[index], merged[index].sum / 1e9,
+            othello_metrics_query_names[index],
+            (unsigned long)merged[index].count);
+  }
+
+  fprintf(stream, "# HELP othello_query_failures_total Queries whose handler "
+                  "failed, the player is then disconnected.\n"
+                  "# TYPE othello_query_failures_total counter\n");
+  for (index = 0; index < OTHELLO_METRICS_QUERIES; index++) {
+    if (merged[index].count > 0) {
+      fprintf(stream, "othello_query_failures_total{query=\"%s\"} %lu\n",
+              othello_metrics_query_names[index],
+              (unsigned long)failures[index]);
+    }
+  }
+
+  for (index = 0; index < OTHELLO_METRICS_COUNTERS; index++) {
+    fprintf(stream, "# HELP %s %s\n# TYPE %s counter\n%s %lu\n",
+            othello_metrics_counter_names[index][0],
+            othello_metrics_counter_names[index][1],
+            othello_metrics_counter_names[index][0],
+            othello_metrics_counter_names[index][0],
+            (unsigned long)counters[index]);
+  }
+
+  for (index = 0; index < OTHELLO_METRICS_GAUGES; index++) {
+    fprintf(stream, "# HELP %s %s\n# TYPE %s gauge\n%s %ld\n",
+            othello_metrics_gauge_names[index][0],
+            othello_metrics_gauge_names[index][1],
+            othello_metrics_gauge_names[index][0],
+            othello_metrics_gauge_names[index][0],
+            __atomic_load_n(othello_metrics_gauges + index, __ATOMIC_RELAXED));
+  }
+
+  free(merged);
+}
+
+/**
+ * the request is read until its blank line then ignored, every path gives
+ * the metrics
+ */
+static void othello_metrics_serve(int socket) {
+  char request[OTHELLO_METRICS_REQUEST_LENGTH];
+  size_t request_length, response_length;
+  ssize_t bytes;
+  struct timeval timeout;
+  FILE *stream;
+  char *response, *cursor;
+
+  timeout.tv_sec = OTHELLO_METRICS_TIMEOUT;
+  timeout.tv_usec = 0;
+  setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  request_length = 0;
+  while (request_length < sizeof(request) - 1 &&
+         (bytes = read(socket, request + request_length,
+                       sizeof(request) - 1 - request_length)) > 0) {
+    request_length += bytes;
+    request[request_length] = '\0';
+    if (strstr(request, "\r\n\r\n") != NULL ||
+        strstr(request, "\n\n") != NULL) {
+      break;
+    }
+  }
+
+  response = NULL;
+  response_length = 0;
+  if ((stream = open_memstream(&response, &response_length)) == NULL) {
+    return;
+  }
+  fprintf(stream, "HTTP/1.0 200 OK\r\n"
+                  "Content-Type: text/plain; version=0.0.4\r\n"
+                  "Connection: close\r\n\r\n");
+  othello_metrics_print(stream);
+  if (fclose(stream) != 0) {
+    free(response);
+    return;
+  }
+
+  for (cursor = response; cursor < response + response_length &&
+                          (bytes = write(socket, cursor,
+                                         response + response_length -
+                                             cursor)) > 0;
+       cursor += bytes) {
+  }
+
+  free(response);
+}
+
+/**
+ * scrapes are rare, they are served one at a time
+ */
+static void *othello_metrics_start(void *arg) {
+  int socket;
+
+  (void)arg;
+
+  for (;;) {
+    if ((socket = accept(othello_metrics_socket, NULL, NULL)) < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      break;
+    }
+    othello_metrics_serve(socket);
+    close(socket);
+  }
+
+  return NULL;
+}
+
+/**
+ * only the loopback interface, the metrics are not meant to be public
+ */
+int othello_metrics_init(unsigned short port) {
+  struct sockaddr_in address;
+  pthread_t thread;
+  int one;
+
+  if ((othello_metrics_shards = calloc(
+           OTHELLO_METRICS_SHARDS, sizeof(othello_metrics_shard_t))) == NULL) {
+    return -1;
+  }
+
+  if (pthread_key_create(&othello_metrics_key, free)) {
+    return -1;
+  }
+
+  if ((othello_metrics_socket = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+    return -1;
+  }
+
+  one = 1;
+  setsockopt(othello_metrics_socket, SOL_SOCKET, SO_REUSEADDR, &one,
+             sizeof(one));
+
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (bind(othello_metrics_socket, (struct sockaddr *)&address,
+           sizeof(address)) < 0 ||
+      listen(othello_metrics_socket, SOMAXCONN) < 0) {
+    close(othello_metrics_socket);
+    return -1;
+  }
+
+  othello_metrics_enabled = true;
+
+  if (pthread_create(&thread, NULL, othello_metrics_start, NULL) ||
+      pthread_detach(thread)) {
+    othello_metrics_enabled = false;
+    close(othello_metrics_socket);
+    return -1;
+  }
+
+  return 0;
+}
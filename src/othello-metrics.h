@@ -0,0 +1,81 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_METRICS_H
+#define OTHELLO_METRICS_H
+
+#include "othello.h"
+
+#include <stdint.h>
+#include <time.h>
+
+#define OTHELLO_METRICS_SHARDS 64 /*threads beyond share the shards*/
+
+enum othello_metrics_counter_e {
+  OTHELLO_METRICS_BYTES_RECEIVED,
+  OTHELLO_METRICS_BYTES_SENT,
+  OTHELLO_METRICS_BROADCASTS, /*frames sent to another player than the one
+                                whose query is handled*/
+  OTHELLO_METRICS_COUNTERS
+};
+
+enum othello_metrics_gauge_e {
+  OTHELLO_METRICS_CONNECTIONS,
+  OTHELLO_METRICS_ROOMS,
+  OTHELLO_METRICS_GAMES,
+  OTHELLO_METRICS_GAUGES
+};
+
+typedef enum othello_metrics_counter_e othello_metrics_counter_t;
+typedef enum othello_metrics_gauge_e othello_metrics_gauge_t;
+
+/**
+ * start the thread serving the metrics in the Prometheus text format on a
+ * port of the loopback interface, the metrics are not recorded until then
+ * \param port port to listen
+ * \return a negative value on failure
+ */
+int othello_metrics_init(unsigned short port);
+
+/**
+ * start the handling of a query
+ * \param player player whose query is handled, its frames are not broadcasts
+ * \param start filled with the current time
+ */
+void othello_metrics_query_begin(const void *player, struct timespec *start);
+
+/**
+ * record the duration of a query in the histogram of the calling thread,
+ * safe to call from any thread without a lock, does nothing if the metrics
+ * are disabled
+ * \param query type of the query
+ * \param start time given by othello_metrics_query_begin
+ * \param status status of the handler
+ */
+void othello_metrics_query_end(char query, const struct timespec *start,
+                               othello_status_t status);
+
+/**
+ * add to a counter, as othello_metrics_query_end
+ * \param counter counter to increase
+ * \param value value to add
+ */
+void othello_metrics_count(othello_metrics_counter_t counter, uint64_t value);
+
+/**
+ * count frames sent to a player as broadcasts if the calling thread does not
+ * handle a query of this player, as othello_metrics_query_end
+ * \param player recipient
+ * \param count count of frames
+ */
+void othello_metrics_frames(const void *player, int count);
+
+/**
+ * change a gauge, as othello_metrics_query_end
+ * \param gauge gauge to change
+ * \param delta value to add, negative to remove
+ */
+void othello_metrics_gauge(othello_metrics_gauge_t gauge, int delta);
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-pool.h"
+
+#include <stdbool.h>
+#include <sys/mman.h>
+
+#define OTHELLO_POOL_INDEX_MASK UINT64_C(0xffffffff)
+#define OTHELLO_POOL_TAG UINT64_C(0x100000000)
+
+/**
+ * a free slot holds index + 1 of the next free slot, 0 for the last one
+ */
+static unsigned int *othello_pool_next(othello_pool_t *pool,
+                                       unsigned int index) {
+  return (unsigned int *)(pool->slots + index * pool->slot_length);
+}
+
+/**
+ * the memory is reserved without being committed, a page is only backed once
+ * a slot on it is used
+ */
+int othello_pool_init(othello_pool_t *pool, size_t slot_length,
+                      unsigned int length) {
+  pool->slot_length = (slot_length + OTHELLO_POOL_ALIGNMENT - 1) /
+                      OTHELLO_POOL_ALIGNMENT * OTHELLO_POOL_ALIGNMENT;
+  pool->length = length;
+  pool->bump = 0;
+  pool->free = 0;
+  pool->used = 0;
+
+  if ((pool->slots = mmap(NULL, pool->slot_length * length,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1,
+                          0)) == MAP_FAILED) {
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * recycled slots first, the tag changes on every push and pop so a stale top
+ * read by a concurrent pop makes its exchange fail (ABA)
+ */
+void *othello_pool_get(othello_pool_t *pool) {
+  uint64_t free, next;
+  unsigned int index;
+
+  free = __atomic_load_n(&(pool->free), __ATOMIC_ACQUIRE);
+  while ((free & OTHELLO_POOL_INDEX_MASK) != 0) {
+    index = (free & OTHELLO_POOL_INDEX_MASK) - 1;
+    next = ((free & ~OTHELLO_POOL_INDEX_MASK) + OTHELLO_POOL_TAG) |
+           __atomic_load_n(othello_pool_next(pool, index), __ATOMIC_RELAXED);
+    if (__atomic_compare_exchange_n(&(pool->free), &free, next, true,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+      __atomic_add_fetch(&(pool->used), 1, __ATOMIC_RELAXED);
+      return pool->slots + index * pool->slot_length;
+    }
+  }
+
+  index = __atomic_load_n(&(pool->bump), __ATOMIC_RELAXED);
+  do {
+    if (index >= pool->length) {
+      return NULL;
+    }
+  } while (!__atomic_compare_exchange_n(&(pool->bump), &index, index + 1, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+  __atomic_add_fetch(&(pool->used), 1, __ATOMIC_RELAXED);
+
+  return pool->slots + index * pool->slot_length;
+}
+
+/**
+ *
+ */
+void othello_pool_put(othello_pool_t *pool, void *slot) {
+  uint64_t free, next;
+  unsigned int index;
+
+  index = ((char *)slot - pool->slots) / pool->slot_length;
+
+  free = __atomic_load_n(&(pool->free), __ATOMIC_RELAXED);
+  do {
+    __atomic_store_n(othello_pool_next(pool, index),
+                     (unsigned int)(free & OTHELLO_POOL_INDEX_MASK),
+                     __ATOMIC_RELAXED);
+    next = ((free & ~OTHELLO_POOL_INDEX_MASK) + OTHELLO_POOL_TAG) |
+           (index + 1);
+  } while (!__atomic_compare_exchange_n(&(pool->free), &free, next, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+  __atomic_sub_fetch(&(pool->used), 1, __ATOMIC_RELAXED);
+}
+
+/**
+ *
+ */
+unsigned int othello_pool_used(othello_pool_t *pool) {
+  return __atomic_load_n(&(pool->used), __ATOMIC_RELAXED);
+}
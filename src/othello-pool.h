@@ -0,0 +1,59 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_POOL_H
+#define OTHELLO_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OTHELLO_POOL_ALIGNMENT 64 /*size of a cache line*/
+
+/**
+ * fixed count of fixed size slots, reserved at once but only backed by memory
+ * once used, free slots are recycled through a lock-free stack
+ */
+struct othello_pool_s {
+  char *slots;
+  size_t slot_length;  /*rounded up to OTHELLO_POOL_ALIGNMENT*/
+  unsigned int length; /*count of slots*/
+  unsigned int bump;   /*slots above were never used*/
+  uint64_t free;       /*tag on the high half, index + 1 of the top slot on the
+                         low half, 0 if the stack is empty*/
+  unsigned int used;
+};
+
+typedef struct othello_pool_s othello_pool_t;
+
+/**
+ * reserve the slots of a pool
+ * \param pool pool to initialize
+ * \param slot_length size of a slot
+ * \param length count of slots
+ * \return a negative value on failure
+ */
+int othello_pool_init(othello_pool_t *pool, size_t slot_length,
+                      unsigned int length);
+
+/**
+ * take a slot, safe to call from any thread
+ * \param pool current pool
+ * \return an aligned slot with an undefined content, NULL if every slot is used
+ */
+void *othello_pool_get(othello_pool_t *pool);
+
+/**
+ * give back a slot taken with othello_pool_get, safe to call from any thread
+ * \param pool current pool
+ * \param slot slot to give back
+ */
+void othello_pool_put(othello_pool_t *pool, void *slot);
+
+/**
+ * count of slots currently taken
+ * \param pool current pool
+ */
+unsigned int othello_pool_used(othello_pool_t *pool);
+
+#endif
@@ -0,0 +1,801 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-search.h"
+#include "othello-eval.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OTHELLO_SEARCH_CHECK_NODES 1023 /*nodes between two clock reads*/
+#define OTHELLO_SEARCH_HISTORY_MAX (1 << 24)
+#define OTHELLO_SEARCH_PARITY_EMPTIES 6 /*ordered by parity only*/
+#define OTHELLO_SEARCH_SCAN_EMPTIES 3 /*tried without generating strokes*/
+#define OTHELLO_SEARCH_TABLE_EMPTIES 10 /*fewer are not worth a table entry*/
+#define OTHELLO_SEARCH_ENDGAME_KEY UINT64_C(0x5a17c0de5a17c0de)
+#define OTHELLO_SEARCH_CORNERS UINT64_C(0x8100000000000081)
+#define OTHELLO_SEARCH_QUADRANTS 4
+
+/**
+ * value of a disc on each square, corners are stable, squares next to an empty
+ * corner give it away
+ */
+static const int othello_search_weights[OTHELLO_BOARD_LENGTH *
+                                        OTHELLO_BOARD_LENGTH] = {
+    100, -20, 10, 5,  5,  10, -20, 100, -20, -50, -2, -2, -2, -2, -50, -20,
+    10,  -2,  1,  1,  1,  1,  -2,  10,  5,   -2,  1,  0,  0,  1,  -2,  5,
+    5,   -2,  1,  0,  0,  1,  -2,  5,   10,  -2,  1,  1,  1,  1,  -2,  10,
+    -20, -50, -2, -2, -2, -2, -50, -20, 100, -20, 10, 5,  5,  10, -20, 100};
+
+/**
+ * copy of the search run by a helper thread
+ */
+struct othello_search_helper_s {
+  othello_search_t search;
+  othello_board_t board;
+  othello_bitboard_t moves;
+  int side;
+  int empties;
+  int number; /*1 for the first helper, 0 if the thread is not started*/
+  pthread_t thread;
+};
+
+typedef struct othello_search_helper_s othello_search_helper_t;
+
+static const othello_bitboard_t
+    othello_search_quadrants[OTHELLO_SEARCH_QUADRANTS] = {
+        UINT64_C(0x000000000f0f0f0f), UINT64_C(0x00000000f0f0f0f0),
+        UINT64_C(0x0f0f0f0f00000000), UINT64_C(0xf0f0f0f000000000)};
+
+/**
+ *
+ */
+static bool othello_search_expired(othello_search_t *search) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return now.tv_sec > search->deadline.tv_sec ||
+         (now.tv_sec == search->deadline.tv_sec &&
+          now.tv_nsec >= search->deadline.tv_nsec);
+}
+
+/**
+ * the flag of a helper is raised by the main thread
+ */
+static bool othello_search_stopped(othello_search_t *search) {
+  return __atomic_load_n(&(search->stopped), __ATOMIC_RELAXED);
+}
+
+/**
+ *
+ */
+static void othello_search_stop(othello_search_t *search) {
+  __atomic_store_n(&(search->stopped), true, __ATOMIC_RELAXED);
+}
+
+/**
+ * \param budget milliseconds from now
+ */
+static void othello_search_deadline(othello_search_t *search, long budget) {
+  clock_gettime(CLOCK_MONOTONIC, &(search->deadline));
+  search->deadline.tv_sec += budget / 1000;
+  search->deadline.tv_nsec += budget % 1000 * 1000000;
+  if (search->deadline.tv_nsec >= 1000000000) {
+    search->deadline.tv_sec++;
+    search->deadline.tv_nsec -= 1000000000;
+  }
+}
+
+/**
+ * \return the milliseconds left before the deadline
+ */
+static long othello_search_remaining(othello_search_t *search) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (search->deadline.tv_sec - now.tv_sec) * 1000 +
+         (search->deadline.tv_nsec - now.tv_nsec) / 1000000;
+}
+
+/**
+ * stroke of the transposition table first, history of the cutoffs next, then
+ * the value of the square
+ * \return the count of strokes
+ */
+static int othello_search_order(othello_search_t *search,
+                                othello_bitboard_t moves, int side,
+                                int table_move, int *squares) {
+  int keys[OTHELLO_SEARCH_MAX_MOVES];
+  int count, square, key, i;
+
+  count = 0;
+  while (moves) {
+    square = __builtin_ctzll(moves);
+    moves &= moves - 1;
+    key = square == table_move ? INT_MAX
+                               : search->history[side][square] * 16 +
+                                     othello_search_weights[square];
+
+    /*insertion sort, there are few strokes*/
+    for (i = count; i > 0 && keys[i - 1] < key; i--) {
+      keys[i] = keys[i - 1];
+      squares[i] = squares[i - 1];
+    }
+    keys[i] = key;
+    squares[i] = square;
+    count++;
+  }
+
+  return count;
+}
+
+/**
+ * the history is halved before it could overflow the ordering keys
+ */
+static void othello_search_cutoff(othello_search_t *search, int side,
+                                  int square, int depth) {
+  int i;
+
+  if ((search->history[side][square] += depth * depth) >
+      OTHELLO_SEARCH_HISTORY_MAX) {
+    for (i = 0; i < OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH; i++) {
+      search->history[side][i] /= 2;
+    }
+  }
+}
+
+/**
+ * disc difference of a finished game, shifted above any evaluation
+ */
+static int othello_search_final(const othello_board_t *board, int side) {
+  int difference;
+
+  difference =
+      othello_board_score(board, side) - othello_board_score(board, !side);
+  if (difference > 0) {
+    return OTHELLO_SEARCH_WIN + difference;
+  }
+  if (difference < 0) {
+    return -OTHELLO_SEARCH_WIN + difference;
+  }
+
+  return 0;
+}
+
+/**
+ * a pass does not use depth, two passes in a row end the game
+ */
+static int othello_search_negamax(othello_search_t *search,
+                                  const othello_board_t *board, int side,
+                                  int depth, int alpha, int beta, bool passed) {
+  othello_board_t child;
+  othello_bitboard_t moves;
+  othello_table_hit_t hit;
+  othello_table_bound_t bound;
+  uint64_t key;
+  int squares[OTHELLO_SEARCH_MAX_MOVES];
+  int count, score, best, best_move, alpha_start, i;
+
+  if ((++(search->nodes) & OTHELLO_SEARCH_CHECK_NODES) == 0 &&
+      othello_search_expired(search)) {
+    othello_search_stop(search);
+  }
+  if (othello_search_stopped(search)) {
+    return 0;
+  }
+
+  if ((moves = othello_board_moves(board, side)) == 0) {
+    if (passed) {
+      return othello_search_final(board, side);
+    }
+    return -othello_search_negamax(search, board, !side, depth, -beta, -alpha,
+                                   true);
+  }
+
+  if (depth == 0) {
+    return othello_search_evaluate(board, side);
+  }
+
+  key = 0;
+  hit.move = OTHELLO_TABLE_NO_MOVE;
+  if (search->table != NULL) {
+    key = othello_table_hash(board, side);
+    if (othello_table_probe(search->table, key, &hit) && hit.depth >= depth &&
+        (hit.bound == OTHELLO_TABLE_EXACT ||
+         (hit.bound == OTHELLO_TABLE_LOWER && hit.score >= beta) ||
+         (hit.bound == OTHELLO_TABLE_UPPER && hit.score <= alpha))) {
+      return hit.score;
+    }
+  }
+
+  count = othello_search_order(search, moves, side, hit.move, squares);
+  alpha_start = alpha;
+  best = -OTHELLO_SEARCH_INFINITY;
+  best_move = OTHELLO_TABLE_NO_MOVE;
+  for (i = 0; i < count; i++) {
+    child = *board;
+    othello_board_apply(&child, side, squares[i],
+                        othello_board_flips(&child, side, squares[i]));
+    score = -othello_search_negamax(search, &child, !side, depth - 1, -beta,
+                                    -alpha, false);
+    if (othello_search_stopped(search)) {
+      return 0;
+    }
+
+    if (score > best) {
+      best = score;
+      best_move = squares[i];
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) {
+          othello_search_cutoff(search, side, squares[i], depth);
+          break;
+        }
+      }
+    }
+  }
+
+  if (search->table != NULL) {
+    if (best >= beta) {
+      bound = OTHELLO_TABLE_LOWER;
+    } else if (best > alpha_start) {
+      bound = OTHELLO_TABLE_EXACT;
+    } else {
+      bound = OTHELLO_TABLE_UPPER;
+      best_move = OTHELLO_TABLE_NO_MOVE;
+    }
+    othello_table_store(search->table, key, best, depth, best_move, bound);
+  }
+
+  return best;
+}
+
+/**
+ * disc difference of a board with one empty square left, without generating
+ * the strokes
+ */
+static int othello_search_last(othello_search_t *search,
+                               const othello_board_t *board, int side,
+                               int square) {
+  othello_bitboard_t flips;
+  int margin;
+
+  search->nodes++;
+  margin = othello_bitboard_count(board->discs[side]) -
+           othello_bitboard_count(board->discs[!side]);
+
+  if ((flips = othello_board_flips(board, side, square)) != 0) {
+    return margin + 2 * othello_bitboard_count(flips) + 1;
+  }
+  if ((flips = othello_board_flips(board, !side, square)) != 0) {
+    return margin - 2 * othello_bitboard_count(flips) - 1;
+  }
+
+  return margin;
+}
+
+/**
+ * exact search of the last empty squares, the squares of the quadrants with
+ * an odd count of empty squares are tried first: the side playing there is
+ * likely to get the last stroke of the quadrant, with very few empty squares
+ * left, trying each of them is cheaper than generating the strokes
+ */
+static int othello_search_parity(othello_search_t *search,
+                                 const othello_board_t *board, int side,
+                                 int empty_count, int alpha, int beta,
+                                 bool passed) {
+  othello_board_t child;
+  othello_bitboard_t empties, candidates, odd, squares, flips;
+  int score, best, square, quadrant, pass;
+  bool played;
+
+  empties = ~(board->discs[OTHELLO_BOARD_BLACK] |
+              board->discs[OTHELLO_BOARD_WHITE]);
+  if (empty_count == 0) {
+    search->nodes++;
+    return othello_bitboard_count(board->discs[side]) -
+           othello_bitboard_count(board->discs[!side]);
+  }
+  if (empty_count == 1) {
+    return othello_search_last(search, board, side, __builtin_ctzll(empties));
+  }
+
+  search->nodes++;
+  candidates = empty_count > OTHELLO_SEARCH_SCAN_EMPTIES
+                   ? othello_board_moves(board, side)
+                   : empties;
+  odd = 0;
+  for (quadrant = 0; quadrant < OTHELLO_SEARCH_QUADRANTS; quadrant++) {
+    if (othello_bitboard_count(empties &
+                               othello_search_quadrants[quadrant]) & 1) {
+      odd |= othello_search_quadrants[quadrant];
+    }
+  }
+
+  best = -OTHELLO_SEARCH_INFINITY;
+  played = false;
+  for (pass = 0; pass < 2; pass++) {
+    for (squares = candidates & (pass ? ~odd : odd); squares;
+         squares &= squares - 1) {
+      square = __builtin_ctzll(squares);
+      if ((flips = othello_board_flips(board, side, square)) == 0) {
+        continue;
+      }
+      played = true;
+      child = *board;
+      othello_board_apply(&child, side, square, flips);
+      score = -othello_search_parity(search, &child, !side, empty_count - 1,
+                                     -beta, -alpha, false);
+      if (score > best) {
+        best = score;
+        if (score > alpha) {
+          alpha = score;
+          if (alpha >= beta) {
+            return best;
+          }
+        }
+      }
+    }
+  }
+
+  if (!played) {
+    if (passed) {
+      return othello_bitboard_count(board->discs[side]) -
+             othello_bitboard_count(board->discs[!side]);
+    }
+    return -othello_search_parity(search, board, !side, empty_count, -beta,
+                                  -alpha, true);
+  }
+
+  return best;
+}
+
+/**
+ * fastest first: strokes leaving the opponent the fewest answers go first,
+ * corner answers count twice, the frontier breaks ties, the stroke of the
+ * transposition table goes before all of them
+ * \return the count of strokes
+ */
+static int othello_search_fastest(const othello_board_t *board,
+                                  othello_bitboard_t moves, int side,
+                                  int table_move, int *squares) {
+  othello_board_t child;
+  othello_bitboard_t answers;
+  int keys[OTHELLO_SEARCH_MAX_MOVES];
+  int count, square, key, i;
+
+  count = 0;
+  while (moves) {
+    square = __builtin_ctzll(moves);
+    moves &= moves - 1;
+    if (square == table_move) {
+      key = INT_MAX;
+    } else {
+      child = *board;
+      othello_board_apply(&child, side, square,
+                          othello_board_flips(&child, side, square));
+      answers = othello_board_moves(&child, !side);
+      key = -16 * (othello_bitboard_count(answers) +
+                   othello_bitboard_count(answers & OTHELLO_SEARCH_CORNERS)) -
+            2 * othello_bitboard_count(othello_board_frontier(&child, side));
+    }
+
+    for (i = count; i > 0 && keys[i - 1] < key; i--) {
+      keys[i] = keys[i - 1];
+      squares[i] = squares[i - 1];
+    }
+    keys[i] = key;
+    squares[i] = square;
+    count++;
+  }
+
+  return count;
+}
+
+/**
+ * exact search of the final disc difference, principal variation search: the
+ * strokes after the first one are only proved worse with a null window
+ */
+static int othello_search_solve(othello_search_t *search,
+                                const othello_board_t *board, int side,
+                                int empties, int alpha, int beta,
+                                bool passed) {
+  othello_board_t child;
+  othello_bitboard_t moves;
+  othello_table_hit_t hit;
+  othello_table_bound_t bound;
+  uint64_t key;
+  int squares[OTHELLO_SEARCH_MAX_MOVES];
+  int count, score, best, best_move, alpha_start, i;
+  bool stored;
+
+  /*a stopped search must not store its partial scores*/
+  if (othello_search_stopped(search)) {
+    return 0;
+  }
+  if (empties <= OTHELLO_SEARCH_PARITY_EMPTIES) {
+    return othello_search_parity(search, board, side, empties, alpha, beta,
+                                 passed);
+  }
+
+  /*the nodes of the parity search are counted without reading the clock*/
+  if (++(search->nodes) - search->checked > OTHELLO_SEARCH_CHECK_NODES) {
+    search->checked = search->nodes;
+    if (othello_search_expired(search)) {
+      othello_search_stop(search);
+      return 0;
+    }
+  }
+  if ((moves = othello_board_moves(board, side)) == 0) {
+    if (passed) {
+      return othello_bitboard_count(board->discs[side]) -
+             othello_bitboard_count(board->discs[!side]);
+    }
+    return -othello_search_solve(search, board, !side, empties, -beta, -alpha,
+                                 true);
+  }
+
+  /*the exact scores must not be mixed with the heuristic ones*/
+  key = 0;
+  hit.move = OTHELLO_TABLE_NO_MOVE;
+  stored = search->table != NULL && empties >= OTHELLO_SEARCH_TABLE_EMPTIES;
+  if (stored) {
+    key = othello_table_hash(board, side) ^ OTHELLO_SEARCH_ENDGAME_KEY;
+    if (othello_table_probe(search->table, key, &hit) &&
+        (hit.bound == OTHELLO_TABLE_EXACT ||
+         (hit.bound == OTHELLO_TABLE_LOWER && hit.score >= beta) ||
+         (hit.bound == OTHELLO_TABLE_UPPER && hit.score <= alpha))) {
+      return hit.score;
+    }
+  }
+
+  count = othello_search_fastest(board, moves, side, hit.move, squares);
+  alpha_start = alpha;
+  best = -OTHELLO_SEARCH_INFINITY;
+  best_move = OTHELLO_TABLE_NO_MOVE;
+  for (i = 0; i < count; i++) {
+    child = *board;
+    othello_board_apply(&child, side, squares[i],
+                        othello_board_flips(&child, side, squares[i]));
+    if (i == 0) {
+      score = -othello_search_solve(search, &child, !side, empties - 1, -beta,
+                                    -alpha, false);
+    } else {
+      score = -othello_search_solve(search, &child, !side, empties - 1,
+                                    -alpha - 1, -alpha, false);
+      if (score > alpha && score < beta) {
+        score = -othello_search_solve(search, &child, !side, empties - 1,
+                                      -beta, -score, false);
+      }
+    }
+    if (othello_search_stopped(search)) {
+      return 0;
+    }
+
+    if (score > best) {
+      best = score;
+      best_move = squares[i];
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) {
+          break;
+        }
+      }
+    }
+  }
+
+  if (stored) {
+    if (best >= beta) {
+      bound = OTHELLO_TABLE_LOWER;
+    } else if (best > alpha_start) {
+      bound = OTHELLO_TABLE_EXACT;
+    } else {
+      bound = OTHELLO_TABLE_UPPER;
+      best_move = OTHELLO_TABLE_NO_MOVE;
+    }
+    othello_table_store(search->table, key, best, empties, best_move, bound);
+  }
+
+  return best;
+}
+
+/**
+ * helpers start from another stroke so the threads fill different parts of
+ * the shared table
+ */
+static void othello_search_rotate(int *squares, int count, int helper) {
+  int rotated[OTHELLO_SEARCH_MAX_MOVES];
+  int i;
+
+  if (helper == 0 || count < 2) {
+    return;
+  }
+  for (i = 0; i < count; i++) {
+    rotated[i] = squares[(i + helper) % count];
+  }
+  memcpy(squares, rotated, count * sizeof(int));
+}
+
+/**
+ * best stroke of the exact search, the score is the final disc difference
+ */
+static int othello_search_endgame(othello_search_t *search,
+                                  const othello_board_t *board, int side,
+                                  othello_bitboard_t moves, int empties,
+                                  int helper) {
+  othello_board_t child;
+  int squares[OTHELLO_SEARCH_MAX_MOVES];
+  int count, score, alpha, best, i;
+
+  count = othello_search_fastest(board, moves, side, OTHELLO_TABLE_NO_MOVE,
+                                 squares);
+  othello_search_rotate(squares, count, helper);
+  alpha = -OTHELLO_SEARCH_INFINITY;
+  best = squares[0];
+  for (i = 0; i < count; i++) {
+    child = *board;
+    othello_board_apply(&child, side, squares[i],
+                        othello_board_flips(&child, side, squares[i]));
+    if (i == 0) {
+      score = -othello_search_solve(search, &child, !side, empties - 1,
+                                    -OTHELLO_SEARCH_INFINITY, -alpha, false);
+    } else {
+      score = -othello_search_solve(search, &child, !side, empties - 1,
+                                    -alpha - 1, -alpha, false);
+      if (score > alpha) {
+        score = -othello_search_solve(search, &child, !side, empties - 1,
+                                      -OTHELLO_SEARCH_INFINITY, -score,
+                                      false);
+      }
+    }
+    if (othello_search_stopped(search)) {
+      return best;
+    }
+    if (score > alpha) {
+      alpha = score;
+      best = squares[i];
+    }
+  }
+
+  search->depth = empties;
+  search->score = alpha;
+  search->solved = true;
+
+  return best;
+}
+
+/**
+ * the best stroke of the previous iteration is searched first, a stroke of an
+ * interrupted iteration is kept only if its score is exact, the helpers start
+ * one depth further every other thread and keep deepening until the main
+ * thread stops them, the main thread may start with part of its budget spent
+ */
+static int othello_search_deepen(othello_search_t *search,
+                                 const othello_board_t *board, int side,
+                                 othello_bitboard_t moves, int empties,
+                                 int helper) {
+  othello_board_t child;
+  int squares[OTHELLO_SEARCH_MAX_MOVES];
+  int count, score, alpha, best, best_index, depth, i;
+  long remaining;
+
+  remaining = othello_search_remaining(search);
+  count = othello_search_order(search, moves, side, OTHELLO_TABLE_NO_MOVE,
+                              squares);
+  othello_search_rotate(squares, count, helper);
+  best = squares[0];
+
+  for (depth = 1 + helper % 2; depth <= OTHELLO_SEARCH_MAX_DEPTH; depth++) {
+    alpha = -OTHELLO_SEARCH_INFINITY;
+    best_index = -1;
+    for (i = 0; i < count; i++) {
+      child = *board;
+      othello_board_apply(&child, side, squares[i],
+                          othello_board_flips(&child, side, squares[i]));
+      score = -othello_search_negamax(search, &child, !side, depth - 1,
+                                      -OTHELLO_SEARCH_INFINITY, -alpha, false);
+      if (othello_search_stopped(search)) {
+        break;
+      }
+      if (score > alpha) {
+        alpha = score;
+        best_index = i;
+      }
+    }
+
+    if (best_index >= 0) {
+      best = squares[best_index];
+      search->score = alpha;
+      /*searched first by the next iteration*/
+      for (i = best_index; i > 0; i--) {
+        squares[i] = squares[i - 1];
+      }
+      squares[0] = best;
+    }
+
+    if (othello_search_stopped(search)) {
+      break;
+    }
+    search->depth = depth;
+
+    /*every line reaches the end of the game*/
+    if (depth >= empties) {
+      break;
+    }
+
+    /*the next iteration costs more than every previous one*/
+    if (helper == 0 &&
+        2 * othello_search_remaining(search) < remaining) {
+      break;
+    }
+  }
+
+  return best;
+}
+
+/**
+ * a helper runs the same search as the main thread on its own copy of the
+ * search, only the transposition table is shared
+ */
+static void *othello_search_helper(void *arg) {
+  othello_search_helper_t *helper;
+
+  helper = (othello_search_helper_t *)arg;
+  if (helper->empties <= helper->search.endgame) {
+    othello_search_endgame(&(helper->search), &(helper->board), helper->side,
+                           helper->moves, helper->empties, helper->number);
+  } else {
+    othello_search_deepen(&(helper->search), &(helper->board), helper->side,
+                          helper->moves, helper->empties, helper->number);
+  }
+
+  return NULL;
+}
+
+/**
+ * the helpers are useless without a table to share
+ * \return the helpers started, NULL if there are none
+ */
+static othello_search_helper_t *
+othello_search_helpers_start(othello_search_t *search,
+                             const othello_board_t *board, int side,
+                             othello_bitboard_t moves, int empties) {
+  othello_search_helper_t *helpers;
+  int i;
+
+  if (search->threads < 2 || search->table == NULL ||
+      (helpers = calloc(search->threads - 1,
+                        sizeof(othello_search_helper_t))) == NULL) {
+    return NULL;
+  }
+
+  for (i = 0; i < search->threads - 1; i++) {
+    helpers[i].search = *search;
+    helpers[i].search.threads = 1;
+    helpers[i].board = *board;
+    helpers[i].side = side;
+    helpers[i].moves = moves;
+    helpers[i].empties = empties;
+    helpers[i].number = i + 1;
+    if (pthread_create(&(helpers[i].thread), NULL, othello_search_helper,
+                       &(helpers[i])) != 0) {
+      helpers[i].number = 0; /*not started*/
+    }
+  }
+
+  return helpers;
+}
+
+/**
+ * the nodes of the helpers are added to the ones of the main thread
+ */
+static void othello_search_helpers_stop(othello_search_t *search,
+                                        othello_search_helper_t *helpers) {
+  int i;
+
+  if (helpers == NULL) {
+    return;
+  }
+
+  for (i = 0; i < search->threads - 1; i++) {
+    if (helpers[i].number != 0) {
+      othello_search_stop(&(helpers[i].search));
+      pthread_join(helpers[i].thread, NULL);
+      search->nodes += helpers[i].search.nodes;
+    }
+  }
+  free(helpers);
+}
+
+/**
+ *
+ */
+void othello_search_init(othello_search_t *search, long budget) {
+  memset(search, 0, sizeof(othello_search_t));
+  search->budget = budget;
+  search->endgame = OTHELLO_SEARCH_DEFAULT_ENDGAME;
+  search->threads = OTHELLO_SEARCH_DEFAULT_THREADS;
+  othello_eval_init();
+  /*the book is probed even without a table*/
+  othello_table_hash_init();
+}
+
+/**
+ * the main thread decides the stroke, the helpers only fill the table
+ */
+int othello_search_run(othello_search_t *search, const othello_board_t *board,
+                       int side) {
+  othello_search_helper_t *helpers;
+  const othello_book_record_t *record;
+  othello_bitboard_t moves;
+  int best, empties, square;
+
+  othello_search_deadline(search, search->budget);
+  search->stopped = false;
+  search->nodes = 0;
+  search->checked = 0;
+  search->depth = 0;
+  search->score = 0;
+  search->solved = false;
+  search->booked = false;
+
+  /*older cutoffs matter less*/
+  for (square = 0; square < OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH;
+       square++) {
+    search->history[side][square] /= 2;
+    search->history[!side][square] /= 2;
+  }
+
+  if ((moves = othello_board_moves(board, side)) == 0) {
+    return -1;
+  }
+
+  if (search->book != NULL &&
+      (record = othello_book_find(search->book,
+                                  othello_table_hash(board, side))) != NULL &&
+      record->move < OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH &&
+      (moves & OTHELLO_BOARD_BIT(record->move))) {
+    search->depth = record->depth;
+    search->score = record->score;
+    search->booked = true;
+    return record->move;
+  }
+
+  if (search->table != NULL) {
+    othello_table_age(search->table);
+  }
+
+  empties = OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH -
+            othello_bitboard_count(board->discs[OTHELLO_BOARD_BLACK] |
+                                   board->discs[OTHELLO_BOARD_WHITE]);
+  helpers = othello_search_helpers_start(search, board, side, moves, empties);
+  if (empties <= search->endgame) {
+    /*the helpers keep solving until the end of the budget*/
+    othello_search_deadline(search, search->budget / 2);
+    best = othello_search_endgame(search, board, side, moves, empties, 0);
+    if (!search->solved) {
+      othello_search_deadline(search, search->budget - search->budget / 2);
+      search->stopped = false;
+      best = othello_search_deepen(search, board, side, moves, empties, 0);
+    }
+  } else {
+    best = othello_search_deepen(search, board, side, moves, empties, 0);
+  }
+  othello_search_helpers_stop(search, helpers);
+
+  return best;
+}
+
+/**
+ * patterns of the board plus the difference of mobility
+ */
+int othello_search_evaluate(const othello_board_t *board, int side) {
+  return othello_eval(board, side);
+}
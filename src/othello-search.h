@@ -0,0 +1,79 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_SEARCH_H
+#define OTHELLO_SEARCH_H
+
+#include "othello-board.h"
+#include "othello-book.h"
+#include "othello-table.h"
+
+#include <stdbool.h>
+#include <time.h>
+
+#define OTHELLO_SEARCH_DEFAULT_BUDGET 50 /*milliseconds per move*/
+#define OTHELLO_SEARCH_DEFAULT_ENDGAME 18 /*empty squares solved exactly*/
+#define OTHELLO_SEARCH_DEFAULT_THREADS 1
+#define OTHELLO_SEARCH_MAX_DEPTH 64
+#define OTHELLO_SEARCH_INFINITY 32000
+/*added to the disc difference of a finished game, above any evaluation*/
+#define OTHELLO_SEARCH_WIN 16000
+#define OTHELLO_SEARCH_MAX_MOVES                                               \
+  (OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH) /*at most one per square*/
+
+/**
+ * state of an iterative deepening negamax search, the history of the cutoffs
+ * is kept from one search to the next one
+ */
+struct othello_search_s {
+  long budget;              /*milliseconds per move*/
+  int endgame; /*empty squares from which the game is solved exactly*/
+  int threads; /*main thread plus helpers sharing the table*/
+  struct timespec deadline; /*CLOCK_MONOTONIC*/
+  bool stopped;             /*the deadline was reached during the search*/
+  unsigned long nodes;
+  unsigned long checked; /*nodes when the clock was last read by the solve*/
+  int depth; /*depth of the last complete iteration*/
+  othello_table_t *table; /*transposition table, NULL if there is none*/
+  othello_book_t *book;   /*opening book, NULL if there is none*/
+  int score; /*score of the best move for the side to play*/
+  bool solved; /*the score is the exact final disc difference*/
+  bool booked; /*the stroke comes from the book, nothing was searched*/
+  int history[OTHELLO_BOARD_SIDES]
+             [OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH];
+};
+
+typedef struct othello_search_s othello_search_t;
+
+/**
+ * initialize a search
+ * \param search search to initialize
+ * \param budget milliseconds per move
+ */
+void othello_search_init(othello_search_t *search, long budget);
+
+/**
+ * find the best stroke, deepen the search until the budget is spent or the
+ * game is solved, try to solve the game exactly within half of the budget once
+ * there are at most search->endgame empty squares and deepen the search with
+ * the rest if it does not end, search->threads - 1 helper threads search the
+ * same position and share the transposition table, a position of the opening
+ * book is not searched at all
+ * \param search current search
+ * \param board current board
+ * \param side side to play
+ * \return the square to play, -1 if side cannot play
+ */
+int othello_search_run(othello_search_t *search, const othello_board_t *board,
+                       int side);
+
+/**
+ * static evaluation of a position
+ * \param board current board
+ * \param side side to play
+ * \return a score for side, positive if side is ahead
+ */
+int othello_search_evaluate(const othello_board_t *board, int side);
+
+#endif
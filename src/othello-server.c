@@ -6,50 +6,188 @@
 #define _GNU_SOURCE
 
 #include "othello.h"
+#include "othello-board.h"
+#include "othello-journal.h"
+#include "othello-log.h"
+#ifdef OTHELLO_LOCK_PROFILE
+#include "othello-lockprof.h"
+#endif
+#include "othello-metrics.h"
+#include "othello-pool.h"
 #include "othello-server.h"
+#include "othello-uring.h"
 
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <poll.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <syslog.h>
 #include <time.h>
 #include <unistd.h>
 
+#define OTHELLO_INPUT_LENGTH 1024
+#define OTHELLO_BACKLOG_LENGTH 65536 /*bytes received during a hand off*/
+#define OTHELLO_EVENTS_LENGTH 256
+#define OTHELLO_BATCH_LENGTH 4
+#define OTHELLO_DEFAULT_OUTPUT_LENGTH 65536
+/*room list reply, the largest frame*/
+#define OTHELLO_MIN_OUTPUT_LENGTH                                              \
+  (2 + OTHELLO_ROOM_ID_LENGTH +                                                \
+   OTHELLO_ROOM_LIST_ENTRY_LENGTH * OTHELLO_ROOM_LIST_LENGTH)
+/*room id, count of players then length and bytes of each name*/
+#define OTHELLO_ROOM_LIST_ENTRY_LENGTH                                         \
+  (OTHELLO_ROOM_ID_LENGTH + 1 +                                                \
+   OTHELLO_ROOM_LENGTH * (1 + OTHELLO_PLAYER_NAME_LENGTH))
+#define OTHELLO_ROOMS_PAGE_LENGTH 256
+#define OTHELLO_DEFAULT_LOBBY_TICK 50 /*milliseconds*/
+#define OTHELLO_LOBBY_EVENT_LENGTH                                             \
+  (2 + OTHELLO_ROOM_ID_LENGTH + OTHELLO_PLAYER_NAME_LENGTH)
+#define OTHELLO_ROOMS_PAGES                                                    \
+  ((OTHELLO_MAX_NUMBER_OF_ROOMS + OTHELLO_ROOMS_PAGE_LENGTH - 1) /             \
+   OTHELLO_ROOMS_PAGE_LENGTH)
+
+/*wait and hold of the room and player mutexes at each call site, built with
+  -D OTHELLO_LOCK_PROFILE (make othello-server-profile), the lock of a send is
+  recorded at the caller of the send*/
+#ifdef OTHELLO_LOCK_PROFILE
+#define OTHELLO_ROOM_LOCK(room) OTHELLO_LOCKPROF_LOCK(&((room)->mutex), "room")
+#define OTHELLO_ROOM_UNLOCK(room) othello_lockprof_unlock(&((room)->mutex))
+#define OTHELLO_PLAYER_LOCK(player)                                            \
+  OTHELLO_LOCKPROF_LOCK(&((player)->mutex), "player")
+#define OTHELLO_PLAYER_LOCK_CALLER(player)                                     \
+  othello_lockprof_lock_at(&((player)->mutex), "player", caller_file,         \
+                           caller_line)
+#define OTHELLO_PLAYER_UNLOCK(player)                                          \
+  othello_lockprof_unlock(&((player)->mutex))
+#else
+#define OTHELLO_ROOM_LOCK(room) pthread_mutex_lock(&((room)->mutex))
+#define OTHELLO_ROOM_UNLOCK(room) pthread_mutex_unlock(&((room)->mutex))
+#define OTHELLO_PLAYER_LOCK(player) pthread_mutex_lock(&((player)->mutex))
+#define OTHELLO_PLAYER_LOCK_CALLER(player) OTHELLO_PLAYER_LOCK(player)
+#define OTHELLO_PLAYER_UNLOCK(player) pthread_mutex_unlock(&((player)->mutex))
+#endif
+
 struct othello_player_s {
-  pthread_t thread;
   int socket;
   char name[OTHELLO_PLAYER_NAME_LENGTH]; /*not necessarily a null-terminated
                                             byte string*/
   othello_room_t *room;
-  pthread_mutex_t mutex; /*to protect the socket on write*/
+  pthread_mutex_t mutex; /*to protect the socket and the output on write*/
   bool ready;            /*if ready to play or if able to play*/
   othello_state_t state;
+  othello_reactor_t *reactor;        /*NULL with a thread per connection*/
+  char input[OTHELLO_INPUT_LENGTH]; /*received bytes*/
+  size_t input_length;              /*count of received bytes*/
+  size_t input_offset;              /*count of bytes consumed by handlers*/
+  othello_reactor_t *hand_off; /*reactor waiting for the player, io_uring*/
+  char *backlog;               /*bytes received after a hand off, io_uring*/
+  size_t backlog_length;       /*count of bytes of the backlog*/
+  bool receiving;              /*multishot receive in flight, io_uring*/
+  bool canceling;              /*receive cancel requested, io_uring*/
+  bool closing;                /*end once the receive is over, io_uring*/
+  char *output;         /*bytes not accepted by the socket yet, lazy allocated*/
+  size_t output_length; /*count of queued bytes*/
+  bool output_polled;   /*socket registered in the writer epoll instance*/
+  bool closed;          /*socket closed, player waiting to be freed*/
+  bool lobby;           /*subscribed to the lobby feed*/
+  unsigned int number;  /*number of the connection, in the journal*/
+};
+
+struct othello_reactor_s {
+  pthread_t thread;
+  int socket;   /*listening socket, shared port with SO_REUSEPORT*/
+  int event_fd; /*epoll instance of the reactor connections*/
+  int pipe[2];  /*players handed off by the other reactors*/
+  othello_uring_t uring; /*replaces the epoll instance with --io-uring*/
 };
 
 struct othello_room_s {
   othello_player_t *players[OTHELLO_ROOM_LENGTH];
   pthread_mutex_t mutex;
-  othello_player_t *grid[OTHELLO_BOARD_LENGTH][OTHELLO_BOARD_LENGTH];
+  othello_board_t board;
+  int scores[OTHELLO_ROOM_LENGTH]; /*discs of each side, updated on stroke*/
+  unsigned short id;
+};
+
+/**
+ * encoded entries of every existing room by increasing id, never modified once
+ * built
+ */
+struct othello_room_list_s {
+  unsigned int version; /*of the rooms when the build started*/
+  int references;       /*protected by the room list mutex*/
+  unsigned int rooms_count;
+  size_t *offsets; /*offset of each entry in data, then the length of data*/
+  char *data;
+};
+
+/**
+ * rooms of consecutive ids, allocated with the first room of the page and
+ * freed with the last one
+ */
+struct othello_rooms_page_s {
+  othello_room_t *rooms[OTHELLO_ROOMS_PAGE_LENGTH];
+  int rooms_count;
+};
+
+/**
+ * frames of one event for one player, flushed with a single system call
+ */
+struct othello_batch_s {
+  othello_player_t *player;
+  struct iovec frames[OTHELLO_BATCH_LENGTH];
+  int frames_count;
 };
 
 /**
  *
  */
-static othello_room_t othello_server_rooms[OTHELLO_NUMBER_OF_ROOMS];
-static othello_room_t othello_server_players[OTHELLO_NUMBER_OF_PLAYERS];
+static othello_rooms_page_t *othello_server_rooms[OTHELLO_ROOMS_PAGES];
+static pthread_mutex_t othello_server_rooms_mutex; /*to protect the pages, taken
+                                                     before a room mutex*/
+static unsigned int othello_server_rooms_length;   /*room ids limit*/
+static unsigned int othello_server_rooms_version;  /*changed on join or leave*/
+static othello_room_list_t *othello_server_room_list; /*last snapshot*/
+static pthread_mutex_t othello_server_room_list_mutex; /*taken before the rooms
+                                                         mutex*/
+static unsigned int othello_server_players_length; /*connections limit*/
+static othello_pool_t othello_server_players; /*slots of the players*/
 static int othello_server_socket;
 static bool othello_server_daemon;
-static pthread_mutex_t othello_server_log_mutex;
+static othello_reactor_t *othello_server_reactors;
+static int othello_server_workers; /*0 for a thread per connection*/
+static bool othello_server_io_uring;
+static unsigned long othello_server_output_length; /*output bound per player*/
+static bool othello_server_overflow_drop;   /*drop frames or disconnect*/
+static int othello_server_writer_fd;        /*epoll instance of the writer*/
+static int othello_server_writer_pipe[2];   /*players to free*/
+static othello_player_t **othello_server_lobby_players; /*subscribers*/
+static size_t othello_server_lobby_players_count;
+static size_t othello_server_lobby_players_capacity;
+static pthread_mutex_t othello_server_lobby_players_mutex;
+static char *othello_server_lobby_events; /*events of the current tick*/
+static size_t othello_server_lobby_events_length;
+static size_t othello_server_lobby_events_capacity;
+static pthread_mutex_t othello_server_lobby_events_mutex; /*taken after a room
+                                                            mutex*/
+static pthread_cond_t othello_server_lobby_events_cond;
+static long othello_server_lobby_tick; /*milliseconds*/
+static unsigned int othello_server_players_number; /*connections accepted*/
 
 /**
  * \return the result of the last call to read
@@ -75,44 +213,355 @@ ssize_t othello_read_all(int fd, void *buf, size_t count) {
 ssize_t othello_write_all(int fd, void *buf, size_t count) {
   ssize_t bytes_write;
   char *cursor;
+  struct pollfd pollfd;
 
   bytes_write = 0;
   cursor = buf;
 
-  while (count > 0 && (bytes_write = write(fd, cursor, count)) > 0) {
-    count -= bytes_write;
-    cursor += bytes_write;
+  pollfd.fd = fd;
+  pollfd.events = POLLOUT;
+
+  while (count > 0) {
+    if ((bytes_write = write(fd, cursor, count)) > 0) {
+      count -= bytes_write;
+      cursor += bytes_write;
+    } else if (bytes_write < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) &&
+               poll(&pollfd, 1, -1) >= 0) {
+      /*non-blocking socket of the event loop with a full send buffer*/
+      continue;
+    } else {
+      break;
+    }
   }
 
   return bytes_write;
 }
 
+/**
+ * \return count, or 0 if the bytes have not been received
+ */
+ssize_t othello_player_read(othello_player_t *player, void *buf,
+                            size_t count) {
+  if (player->input_length - player->input_offset < count) {
+    return 0;
+  }
+
+  memcpy(buf, player->input + player->input_offset, count);
+  player->input_offset += count;
+
+  return count;
+}
+
+/**
+ * the caller holds the player mutex
+ * \return false on a socket error
+ */
+bool othello_player_flush(othello_player_t *player) {
+  ssize_t bytes_write;
+
+  while (player->output_length > 0) {
+    if ((bytes_write = send(player->socket, player->output,
+                            player->output_length,
+                            MSG_DONTWAIT | MSG_NOSIGNAL)) < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    othello_metrics_count(OTHELLO_METRICS_BYTES_SENT, bytes_write);
+    player->output_length -= bytes_write;
+    memmove(player->output, player->output + bytes_write,
+            player->output_length);
+  }
+
+  free(player->output);
+  player->output = NULL;
+
+  return true;
+}
+
+/**
+ * the caller holds the player mutex
+ */
+void othello_player_disconnect(othello_player_t *player) {
+  free(player->output);
+  player->output = NULL;
+  player->output_length = 0;
+  /*the next read of the player fails, its owner ends it*/
+  shutdown(player->socket, SHUT_RDWR);
+}
+
 /**
  *
  */
-void othello_log(int priority, const char *format, ...) {
-  va_list ap;
-  char date[32];
-  time_t t;
-  struct tm *tmp;
+othello_status_t othello_player_send_at(othello_player_t *player, void *buf,
+                                        size_t count OTHELLO_CALLER_PARAMS) {
+  struct iovec frame;
 
-  va_start(ap, format);
+  frame.iov_base = buf;
+  frame.iov_len = count;
 
-  pthread_mutex_lock(&othello_server_log_mutex);
-  if (othello_server_daemon) {
-    vsyslog(priority, format, ap);
-  } else {
-    memset(date, 0, sizeof(date));
-    t = time(NULL);
-    tmp = localtime(&t);
-    if (tmp != NULL) {
-      strftime(date, sizeof(date), "%a %d %H:%M:%S", tmp);
+  return othello_player_sendv_at(player, &frame, 1 OTHELLO_CALLER_ARGS);
+}
+
+/**
+ * frames are either sent, queued or dropped entirely, never partially
+ */
+othello_status_t othello_player_sendv_at(othello_player_t *player,
+                                         struct iovec *frames, int frames_count
+                                         OTHELLO_CALLER_PARAMS) {
+  othello_status_t status;
+  ssize_t bytes_write;
+  size_t count;
+  struct epoll_event event;
+  struct msghdr message;
+  struct iovec *frame_cursor;
+
+  status = OTHELLO_SUCCESS;
+
+  count = 0;
+  for (frame_cursor = frames; frame_cursor < frames + frames_count;
+       frame_cursor++) {
+    count += frame_cursor->iov_len;
+  }
+
+  OTHELLO_PLAYER_LOCK_CALLER(player);
+
+  if (player->closed) {
+    OTHELLO_PLAYER_UNLOCK(player);
+    return OTHELLO_FAILURE;
+  }
+
+  othello_metrics_frames(player, frames_count);
+
+  bytes_write = 0;
+  if (player->output_length == 0) {
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = frames;
+    message.msg_iovlen = frames_count;
+    if ((bytes_write = sendmsg(player->socket, &message,
+                               MSG_DONTWAIT | MSG_NOSIGNAL)) < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        OTHELLO_PLAYER_UNLOCK(player);
+        return OTHELLO_FAILURE;
+      }
+      bytes_write = 0;
+    }
+    othello_metrics_count(OTHELLO_METRICS_BYTES_SENT, bytes_write);
+    if ((size_t)bytes_write == count) {
+      OTHELLO_PLAYER_UNLOCK(player);
+      return status;
+    }
+    count -= bytes_write;
+  }
+
+  if (player->output_length + count > othello_server_output_length) {
+    othello_log(LOG_WARNING, "player %p %d %s - output overflow: %s", player,
+                player->socket, player->name,
+                othello_server_overflow_drop ? "drop" : "disconnect");
+    /*a batch partially sent can't be dropped without breaking the framing*/
+    if (!othello_server_overflow_drop || bytes_write > 0) {
+      othello_player_disconnect(player);
+      status = OTHELLO_FAILURE;
+    }
+    OTHELLO_PLAYER_UNLOCK(player);
+    return status;
+  }
+
+  if (player->output == NULL &&
+      (player->output = malloc(othello_server_output_length)) == NULL) {
+    othello_player_disconnect(player);
+    OTHELLO_PLAYER_UNLOCK(player);
+    return OTHELLO_FAILURE;
+  }
+
+  /*queue the bytes not sent, skipping the ones sent*/
+  for (frame_cursor = frames; frame_cursor < frames + frames_count;
+       frame_cursor++) {
+    if ((size_t)bytes_write >= frame_cursor->iov_len) {
+      bytes_write -= frame_cursor->iov_len;
+      continue;
+    }
+    memcpy(player->output + player->output_length,
+           (char *)frame_cursor->iov_base + bytes_write,
+           frame_cursor->iov_len - bytes_write);
+    player->output_length += frame_cursor->iov_len - bytes_write;
+    bytes_write = 0;
+  }
+
+  /*the writer drains the output once the socket accepts more bytes*/
+  event.events = EPOLLOUT | EPOLLONESHOT;
+  event.data.ptr = player;
+  if (epoll_ctl(othello_server_writer_fd,
+                player->output_polled ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                player->socket, &event) < 0) {
+    othello_player_disconnect(player);
+    status = OTHELLO_FAILURE;
+  }
+  player->output_polled = true;
+
+  OTHELLO_PLAYER_UNLOCK(player);
+
+  return status;
+}
+
+/**
+ *
+ */
+void othello_batch_init(othello_batch_t *batch, othello_player_t *player) {
+  batch->player = player;
+  batch->frames_count = 0;
+}
+
+/**
+ *
+ */
+void othello_batch_add(othello_batch_t *batch, void *buf, size_t count) {
+  if (batch->player == NULL ||
+      batch->frames_count >= OTHELLO_BATCH_LENGTH) {
+    return;
+  }
+
+  batch->frames[batch->frames_count].iov_base = buf;
+  batch->frames[batch->frames_count].iov_len = count;
+  batch->frames_count++;
+}
+
+/**
+ * a failure to reach another player is handled by the owner of this player
+ */
+othello_status_t othello_room_flush_at(othello_batch_t *batches,
+                                       othello_player_t *player
+                                       OTHELLO_CALLER_PARAMS) {
+  othello_status_t status;
+  othello_batch_t *batch_cursor;
+
+  status = OTHELLO_SUCCESS;
+
+  for (batch_cursor = batches; batch_cursor < batches + OTHELLO_ROOM_LENGTH;
+       batch_cursor++) {
+    if (othello_batch_flush_at(batch_cursor OTHELLO_CALLER_ARGS) !=
+            OTHELLO_SUCCESS &&
+        batch_cursor->player == player) {
+      status = OTHELLO_FAILURE;
+    }
+  }
+
+  return status;
+}
+
+/**
+ *
+ */
+othello_status_t othello_batch_flush_at(othello_batch_t *batch
+                                        OTHELLO_CALLER_PARAMS) {
+  othello_status_t status;
+
+  if (batch->player == NULL || batch->frames_count == 0) {
+    return OTHELLO_SUCCESS;
+  }
+
+  status = othello_player_sendv_at(batch->player, batch->frames,
+                                   batch->frames_count OTHELLO_CALLER_ARGS);
+  batch->frames_count = 0;
+
+  return status;
+}
+
+/**
+ * closing a socket removes it from the writer epoll instance, but the writer
+ * may have already fetched an event of the player, so the player is freed by
+ * the writer between two batches of events
+ */
+void *othello_writer_start(void *arg) {
+  int events_count;
+  struct epoll_event event;
+  struct epoll_event events[OTHELLO_EVENTS_LENGTH];
+  struct epoll_event *event_cursor;
+  othello_player_t *player;
+  othello_player_t *retired[OTHELLO_EVENTS_LENGTH];
+  int retired_count;
+
+  for (;;) {
+    if ((events_count = epoll_wait(othello_server_writer_fd, events,
+                                   OTHELLO_EVENTS_LENGTH, -1)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    retired_count = 0;
+
+    for (event_cursor = events; event_cursor < events + events_count;
+         event_cursor++) {
+      if (event_cursor->data.ptr == NULL) {
+        while (retired_count < OTHELLO_EVENTS_LENGTH &&
+               read(othello_server_writer_pipe[0], retired + retired_count,
+                    sizeof(player)) == sizeof(player)) {
+          retired_count++;
+        }
+        continue;
+      }
+
+      player = event_cursor->data.ptr;
+      OTHELLO_PLAYER_LOCK(player);
+      if (!player->closed) {
+        if (!othello_player_flush(player)) {
+          othello_player_disconnect(player);
+        } else if (player->output_length > 0) {
+          event.events = EPOLLOUT | EPOLLONESHOT;
+          event.data.ptr = player;
+          if (epoll_ctl(othello_server_writer_fd, EPOLL_CTL_MOD,
+                        player->socket, &event) < 0) {
+            othello_player_disconnect(player);
+          }
+        }
+      }
+      OTHELLO_PLAYER_UNLOCK(player);
+    }
+
+    while (retired_count > 0) {
+      player = retired[--retired_count];
+      pthread_mutex_destroy(&(player->mutex));
+      othello_pool_put(&othello_server_players, player);
+      othello_metrics_gauge(OTHELLO_METRICS_CONNECTIONS, -1);
     }
-    printf("%s othello-server[%d]: ", date, getpid());
-    vprintf(format, ap);
-    putc('\n', stdout);
   }
-  pthread_mutex_unlock(&othello_server_log_mutex);
+
+  othello_log(LOG_ERR, "writer - %s", strerror(errno));
+
+  return NULL;
+}
+
+/**
+ *
+ */
+int othello_writer_init(void) {
+  int status;
+  struct epoll_event event;
+  pthread_t thread;
+
+  if ((othello_server_writer_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+    return othello_server_writer_fd;
+  }
+
+  if ((status = pipe2(othello_server_writer_pipe, O_CLOEXEC)) < 0 ||
+      (status = fcntl(othello_server_writer_pipe[0], F_SETFL, O_NONBLOCK)) <
+          0) {
+    return status;
+  }
+
+  event.events = EPOLLIN;
+  event.data.ptr = NULL;
+  if ((status = epoll_ctl(othello_server_writer_fd, EPOLL_CTL_ADD,
+                          othello_server_writer_pipe[0], &event)) < 0) {
+    return status;
+  }
+
+  if ((status = pthread_create(&thread, NULL, othello_writer_start, NULL)) ||
+      (status = pthread_detach(thread))) {
+    return -status;
+  }
+
+  return 0;
 }
 
 /**
@@ -121,53 +570,79 @@ void othello_log(int priority, const char *format, ...) {
 void othello_player_end(othello_player_t *player) {
   char notif[1 + sizeof(player->name)];
   othello_player_t **player_cursor;
+  unsigned short room_id;
 
   othello_log(LOG_INFO, "player %p %d %s - logoff", player, player->socket,
               player->name);
 
+  othello_lobby_unsubscribe(player);
+
+  othello_journal_append(OTHELLO_JOURNAL_LOGOFF, player->number,
+                         player->room != NULL ? player->room->id
+                                              : OTHELLO_JOURNAL_NO_ROOM,
+                         0, player->name);
+
   if (player->state == OTHELLO_STATE_IN_GAME) {
     notif[0] = OTHELLO_NOTIF_GIVE_UP;
     memcpy(notif + 1, player->name, sizeof(player->name));
 
-    pthread_mutex_lock(&(player->room->mutex));
+    OTHELLO_ROOM_LOCK(player->room);
     for (player_cursor = player->room->players;
          player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
          player_cursor++) {
       if (*player_cursor != NULL) {
         if (*player_cursor != player) {
-          pthread_mutex_lock(&((*player_cursor)->mutex));
-          othello_write_all((*player_cursor)->socket, notif, sizeof(notif));
-          pthread_mutex_unlock(&((*player_cursor)->mutex));
+          othello_player_send(*player_cursor, notif, sizeof(notif));
         }
         (*player_cursor)->ready = false;
         (*player_cursor)->state = OTHELLO_STATE_IN_ROOM;
       }
     }
-    pthread_mutex_unlock(&(player->room->mutex));
+    othello_lobby_push(player->room->id, OTHELLO_LOBBY_GAME_END, NULL);
+    othello_metrics_gauge(OTHELLO_METRICS_GAMES, -1);
+    othello_journal_append(OTHELLO_JOURNAL_GIVE_UP, player->number,
+                           player->room->id, othello_game_side(player),
+                           player->name);
+    OTHELLO_ROOM_UNLOCK(player->room);
   }
 
   if (player->state == OTHELLO_STATE_IN_ROOM) {
     notif[0] = OTHELLO_NOTIF_ROOM_LEAVE;
     memcpy(notif + 1, player->name, sizeof(player->name));
+    room_id = player->room->id;
 
-    pthread_mutex_lock(&(player->room->mutex));
+    OTHELLO_ROOM_LOCK(player->room);
     for (player_cursor = player->room->players;
          player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
          player_cursor++) {
       if (*player_cursor == player) {
         *player_cursor = NULL;
+        __atomic_add_fetch(&othello_server_rooms_version, 1, __ATOMIC_RELEASE);
+        othello_lobby_push(room_id, OTHELLO_LOBBY_ROOM_LEAVE, player->name);
+        othello_journal_append(OTHELLO_JOURNAL_ROOM_LEAVE, player->number,
+                               room_id, 0, player->name);
       } else if (*player_cursor != NULL) {
-        pthread_mutex_lock(&((*player_cursor)->mutex));
-        othello_write_all((*player_cursor)->socket, notif, sizeof(notif));
-        pthread_mutex_unlock(&((*player_cursor)->mutex));
+        othello_player_send(*player_cursor, notif, sizeof(notif));
       }
     }
-    pthread_mutex_unlock(&(player->room->mutex));
+    OTHELLO_ROOM_UNLOCK(player->room);
+
+    othello_room_release(room_id);
+    player->room = NULL;
   }
 
-  pthread_mutex_destroy(&(player->mutex));
+  OTHELLO_PLAYER_LOCK(player);
+  player->closed = true;
   close(player->socket);
-  free(player);
+  free(player->output);
+  player->output = NULL;
+  OTHELLO_PLAYER_UNLOCK(player);
+
+  free(player->backlog);
+  player->backlog = NULL;
+
+  /*freed by the writer*/
+  othello_write_all(othello_server_writer_pipe[1], &player, sizeof(player));
 }
 
 /**
@@ -183,11 +658,10 @@ othello_status_t othello_handle_login(othello_player_t *player) {
   reply[0] = OTHELLO_QUERY_LOGIN;
   reply[1] = OTHELLO_FAILURE;
 
-  if (othello_read_all(player->socket, &protocol_version,
-                       sizeof(protocol_version)) <= 0 ||
+  if (othello_player_read(player, &protocol_version,
+                          sizeof(protocol_version)) <= 0 ||
       protocol_version != OTHELLO_PROTOCOL_VERSION ||
-      othello_read_all(player->socket, player->name, sizeof(player->name)) <=
-          0) {
+      othello_player_read(player, player->name, sizeof(player->name)) <= 0) {
     status = OTHELLO_FAILURE;
   }
 
@@ -195,13 +669,13 @@ othello_status_t othello_handle_login(othello_player_t *player) {
       player->state == OTHELLO_STATE_NOT_CONNECTED && player->name[0] != '\0') {
     reply[1] = OTHELLO_SUCCESS;
     player->state = OTHELLO_STATE_CONNECTED;
+    othello_journal_append(OTHELLO_JOURNAL_LOGIN, player->number,
+                           OTHELLO_JOURNAL_NO_ROOM, 0, player->name);
   }
 
-  pthread_mutex_lock(&(player->mutex));
-  if (othello_write_all(player->socket, reply, sizeof(reply)) <= 0) {
+  if (othello_player_send(player, reply, sizeof(reply)) != OTHELLO_SUCCESS) {
     status = OTHELLO_FAILURE;
   }
-  pthread_mutex_unlock(&(player->mutex));
 
   othello_log(LOG_INFO, "player %p %d %s - login", player, player->socket,
               player->name);
@@ -214,50 +688,49 @@ othello_status_t othello_handle_login(othello_player_t *player) {
  */
 othello_status_t othello_handle_room_list(othello_player_t *player) {
   othello_status_t status;
-  char reply[1 +
-             (2 + OTHELLO_ROOM_LENGTH * OTHELLO_PLAYER_NAME_LENGTH) *
-                 OTHELLO_NUMBER_OF_ROOMS];
-  char *reply_cursor;
-  char room_id;
-  char room_size;
-  othello_player_t **player_cursor;
-  othello_room_t *room_cursor;
+  char request[OTHELLO_ROOM_ID_LENGTH];
+  char reply[2 + OTHELLO_ROOM_ID_LENGTH];
+  struct iovec frames[2];
+  othello_room_list_t *room_list;
+  unsigned int first, last, middle;
 
-  status = OTHELLO_SUCCESS;
+  if (othello_player_read(player, request, sizeof(request)) <= 0) {
+    return OTHELLO_FAILURE;
+  }
 
-  memset(reply, 0, sizeof(reply));
-  reply[0] = OTHELLO_QUERY_ROOM_LIST;
+  if ((room_list = othello_room_list_acquire()) == NULL) {
+    return OTHELLO_FAILURE;
+  }
 
-  reply_cursor = reply + 1;
-  room_id = 0;
-  for (room_cursor = othello_server_rooms;
-       room_cursor < othello_server_rooms + OTHELLO_NUMBER_OF_ROOMS;
-       room_cursor++) {
-    *reply_cursor = room_id;
-    reply_cursor++;
-    room_size = 0;
-    pthread_mutex_lock(&(room_cursor->mutex));
-    for (player_cursor = room_cursor->players;
-         player_cursor < room_cursor->players + OTHELLO_ROOM_LENGTH;
-         player_cursor++) {
-      if (*player_cursor != NULL) {
-        room_size++;
-        memcpy(reply_cursor, (*player_cursor)->name,
-               OTHELLO_PLAYER_NAME_LENGTH);
-      }
-      reply_cursor += OTHELLO_PLAYER_NAME_LENGTH;
+  /*first entry with an id not lower than the requested one*/
+  first = 0;
+  last = room_list->rooms_count;
+  while (first < last) {
+    middle = first + (last - first) / 2;
+    if (OTHELLO_ROOM_ID_GET(room_list->data + room_list->offsets[middle]) <
+        OTHELLO_ROOM_ID_GET(request)) {
+      first = middle + 1;
+    } else {
+      last = middle;
     }
-    pthread_mutex_unlock(&(room_cursor->mutex));
-    *reply_cursor = room_size;
-    reply_cursor++;
-    room_id++;
   }
-
-  pthread_mutex_lock(&(player->mutex));
-  if (othello_write_all(player->socket, reply, sizeof(reply)) <= 0) {
-    status = OTHELLO_FAILURE;
+  last = first + OTHELLO_ROOM_LIST_LENGTH;
+  if (last > room_list->rooms_count) {
+    last = room_list->rooms_count;
   }
-  pthread_mutex_unlock(&(player->mutex));
+
+  reply[0] = OTHELLO_QUERY_ROOM_LIST;
+  OTHELLO_ROOM_ID_SET(reply + 1, othello_server_rooms_length);
+  reply[1 + OTHELLO_ROOM_ID_LENGTH] = last - first;
+
+  /*the entries are sent from the snapshot, without any copy*/
+  frames[0].iov_base = reply;
+  frames[0].iov_len = sizeof(reply);
+  frames[1].iov_base = room_list->data + room_list->offsets[first];
+  frames[1].iov_len = room_list->offsets[last] - room_list->offsets[first];
+  status = othello_player_sendv(player, frames, 2);
+
+  othello_room_list_release(room_list);
 
   othello_log(LOG_INFO, "player %p %d %s - room list", player, player->socket,
               player->name);
@@ -266,118 +739,540 @@ othello_status_t othello_handle_room_list(othello_player_t *player) {
 }
 
 /**
- *
+ * the version is read before the rooms, a room changed during the build makes
+ * the next request build a new snapshot, an empty room is either left by its
+ * last player and about to be freed or created by a join about to fill it, it
+ * is not listed
  */
-othello_status_t othello_handle_room_join(othello_player_t *player) {
-  othello_status_t status;
-  unsigned char room_id;
-  char reply[2];
-  char notif[1 + OTHELLO_PLAYER_NAME_LENGTH];
+othello_room_list_t *othello_room_list_build(void) {
+  othello_room_list_t *room_list;
+  unsigned int rooms_count, room_id;
+  othello_rooms_page_t **page_cursor;
   othello_room_t *room;
   othello_player_t **player_cursor;
-
-  status = OTHELLO_SUCCESS;
-
-  reply[0] = OTHELLO_QUERY_ROOM_JOIN;
-  reply[1] = OTHELLO_FAILURE;
-
-  notif[0] = OTHELLO_NOTIF_ROOM_JOIN;
-
-  if (othello_read_all(player->socket, &room_id, sizeof(room_id)) <= 0) {
-    status = OTHELLO_FAILURE;
+  char *data_cursor;
+  char *size_cursor;
+  size_t name_length;
+
+  pthread_mutex_lock(&othello_server_rooms_mutex);
+
+  rooms_count = 0;
+  for (page_cursor = othello_server_rooms;
+       page_cursor < othello_server_rooms + OTHELLO_ROOMS_PAGES;
+       page_cursor++) {
+    if (*page_cursor != NULL) {
+      rooms_count += (*page_cursor)->rooms_count;
+    }
   }
 
-  if (status == OTHELLO_SUCCESS && room_id < OTHELLO_NUMBER_OF_ROOMS &&
-      player->state == OTHELLO_STATE_CONNECTED) {
+  if ((room_list = malloc(sizeof(othello_room_list_t) +
+                          (rooms_count + 1) * sizeof(size_t) +
+                          rooms_count * OTHELLO_ROOM_LIST_ENTRY_LENGTH)) ==
+      NULL) {
+    pthread_mutex_unlock(&othello_server_rooms_mutex);
+    return NULL;
+  }
+  room_list->version =
+      __atomic_load_n(&othello_server_rooms_version, __ATOMIC_ACQUIRE);
+  room_list->references = 1;
+  room_list->rooms_count = 0;
+  room_list->offsets = (size_t *)(room_list + 1);
+  room_list->data = (char *)(room_list->offsets + rooms_count + 1);
+
+  data_cursor = room_list->data;
+  for (room_id = 0; room_id < othello_server_rooms_length; room_id++) {
+    if (othello_server_rooms[room_id / OTHELLO_ROOMS_PAGE_LENGTH] == NULL) {
+      room_id |= OTHELLO_ROOMS_PAGE_LENGTH - 1;
+      continue;
+    }
+    if ((room = othello_server_rooms[room_id / OTHELLO_ROOMS_PAGE_LENGTH]
+                    ->rooms[room_id % OTHELLO_ROOMS_PAGE_LENGTH]) == NULL) {
+      continue;
+    }
 
-    room = &(othello_server_rooms[room_id]);
+    room_list->offsets[room_list->rooms_count++] =
+        data_cursor - room_list->data;
+    OTHELLO_ROOM_ID_SET(data_cursor, room_id);
+    data_cursor += OTHELLO_ROOM_ID_LENGTH;
+    size_cursor = data_cursor++;
+    *size_cursor = 0;
 
-    pthread_mutex_lock(&(room->mutex));
+    OTHELLO_ROOM_LOCK(room);
     for (player_cursor = room->players;
-         player_cursor < room->players + OTHELLO_ROOM_LENGTH; player_cursor++) {
-      if (*player_cursor == NULL) {
-        *player_cursor = player;
-        player->room = room;
-        player->state = OTHELLO_STATE_IN_ROOM;
-        player->ready = false;
-        break;
+         player_cursor < room->players + OTHELLO_ROOM_LENGTH;
+         player_cursor++) {
+      if (*player_cursor != NULL) {
+        name_length = strnlen((*player_cursor)->name,
+                              OTHELLO_PLAYER_NAME_LENGTH);
+        *(data_cursor++) = name_length;
+        memcpy(data_cursor, (*player_cursor)->name, name_length);
+        data_cursor += name_length;
+        (*size_cursor)++;
       }
     }
-    if (player->room != NULL) {
-      reply[1] = OTHELLO_SUCCESS;
-      memcpy(notif + 1, player->name, OTHELLO_PLAYER_NAME_LENGTH);
+    OTHELLO_ROOM_UNLOCK(room);
 
-      for (player_cursor = room->players;
-           player_cursor < room->players + OTHELLO_ROOM_LENGTH;
-           player_cursor++) {
-        if (*player_cursor != NULL && *player_cursor != player) {
-          pthread_mutex_lock(&((*player_cursor)->mutex));
-          othello_write_all((*player_cursor)->socket, notif, sizeof(notif));
-          pthread_mutex_unlock(&((*player_cursor)->mutex));
-        }
-      }
+    if (*size_cursor == 0) {
+      data_cursor = room_list->data +
+                    room_list->offsets[--room_list->rooms_count];
     }
-    pthread_mutex_unlock(&(room->mutex));
-
-    othello_log(LOG_INFO, "player %p %d %s - join room: %d", player,
-                player->socket, player->name, room_id);
   }
+  room_list->offsets[room_list->rooms_count] = data_cursor - room_list->data;
 
-  pthread_mutex_lock(&(player->mutex));
-  if (othello_write_all(player->socket, reply, sizeof(reply)) <= 0) {
-    status = OTHELLO_FAILURE;
-  }
-  pthread_mutex_unlock(&(player->mutex));
+  pthread_mutex_unlock(&othello_server_rooms_mutex);
 
-  return status;
+  return room_list;
 }
 
 /**
  *
  */
-othello_status_t othello_handle_room_leave(othello_player_t *player) {
-  othello_status_t status;
-  char reply[2];
-  char notif[1 + OTHELLO_PLAYER_NAME_LENGTH];
-  othello_player_t **player_cursor;
+othello_room_list_t *othello_room_list_acquire(void) {
+  othello_room_list_t *room_list;
 
-  status = OTHELLO_SUCCESS;
+  pthread_mutex_lock(&othello_server_room_list_mutex);
 
-  reply[0] = OTHELLO_QUERY_ROOM_LEAVE;
-  reply[1] = OTHELLO_FAILURE;
+  if (othello_server_room_list == NULL ||
+      othello_server_room_list->version !=
+          __atomic_load_n(&othello_server_rooms_version, __ATOMIC_ACQUIRE)) {
+    if ((room_list = othello_room_list_build()) == NULL) {
+      pthread_mutex_unlock(&othello_server_room_list_mutex);
+      return NULL;
+    }
+    if (othello_server_room_list != NULL &&
+        --othello_server_room_list->references == 0) {
+      free(othello_server_room_list);
+    }
+    othello_server_room_list = room_list;
+  }
 
-  notif[0] = OTHELLO_NOTIF_ROOM_LEAVE;
+  room_list = othello_server_room_list;
+  room_list->references++;
 
-  if (player->state == OTHELLO_STATE_IN_ROOM) {
-    reply[1] = OTHELLO_SUCCESS;
-    memcpy(notif + 1, player->name, OTHELLO_PLAYER_NAME_LENGTH);
+  pthread_mutex_unlock(&othello_server_room_list_mutex);
 
-    pthread_mutex_lock(&(player->room->mutex));
-    for (player_cursor = player->room->players;
-         player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
-         player_cursor++) {
-      if (*player_cursor == player) {
-        *player_cursor = NULL;
-      } else if (*player_cursor != NULL) {
-        pthread_mutex_lock(&((*player_cursor)->mutex));
-        othello_write_all((*player_cursor)->socket, notif, sizeof(notif));
-        pthread_mutex_unlock(&((*player_cursor)->mutex));
-      }
+  return room_list;
+}
+
+/**
+ * a subscriber needs no room lock, the events of the tick are sent at once by
+ * the lobby thread
+ */
+void othello_lobby_push(unsigned short room_id, othello_lobby_t event,
+                        const char *name) {
+  char *events;
+  size_t capacity;
+
+  pthread_mutex_lock(&othello_server_lobby_events_mutex);
+
+  /*nobody listens*/
+  if (__atomic_load_n(&othello_server_lobby_players_count, __ATOMIC_RELAXED) ==
+      0) {
+    pthread_mutex_unlock(&othello_server_lobby_events_mutex);
+    return;
+  }
+
+  if (othello_server_lobby_events_length + OTHELLO_LOBBY_EVENT_LENGTH >
+      othello_server_lobby_events_capacity) {
+    capacity = othello_server_lobby_events_capacity * 2 +
+               OTHELLO_LOBBY_EVENT_LENGTH * OTHELLO_ROOM_LIST_LENGTH;
+    if ((events = realloc(othello_server_lobby_events, capacity)) == NULL) {
+      pthread_mutex_unlock(&othello_server_lobby_events_mutex);
+      return;
     }
-    pthread_mutex_unlock(&(player->room->mutex));
+    othello_server_lobby_events = events;
+    othello_server_lobby_events_capacity = capacity;
+  }
 
-    player->room = NULL;
-    player->state = OTHELLO_STATE_CONNECTED;
+  events = othello_server_lobby_events + othello_server_lobby_events_length;
+  events[0] = OTHELLO_NOTIF_LOBBY;
+  OTHELLO_ROOM_ID_SET(events + 1, room_id);
+  events[1 + OTHELLO_ROOM_ID_LENGTH] = event;
+  if (name != NULL) {
+    memcpy(events + 2 + OTHELLO_ROOM_ID_LENGTH, name,
+           OTHELLO_PLAYER_NAME_LENGTH);
+  } else {
+    memset(events + 2 + OTHELLO_ROOM_ID_LENGTH, 0,
+           OTHELLO_PLAYER_NAME_LENGTH);
+  }
+
+  /*the first event of a tick wakes the lobby thread*/
+  if (othello_server_lobby_events_length == 0) {
+    pthread_cond_signal(&othello_server_lobby_events_cond);
+  }
+  othello_server_lobby_events_length += OTHELLO_LOBBY_EVENT_LENGTH;
+
+  pthread_mutex_unlock(&othello_server_lobby_events_mutex);
+}
+
+/**
+ *
+ */
+othello_status_t othello_lobby_subscribe(othello_player_t *player) {
+  othello_player_t **players;
+  size_t capacity;
+
+  pthread_mutex_lock(&othello_server_lobby_players_mutex);
+
+  if (player->lobby) {
+    pthread_mutex_unlock(&othello_server_lobby_players_mutex);
+    return OTHELLO_FAILURE;
+  }
+
+  if (othello_server_lobby_players_count ==
+      othello_server_lobby_players_capacity) {
+    capacity = othello_server_lobby_players_capacity * 2 + 16;
+    if ((players = realloc(othello_server_lobby_players,
+                           capacity * sizeof(othello_player_t *))) == NULL) {
+      pthread_mutex_unlock(&othello_server_lobby_players_mutex);
+      return OTHELLO_FAILURE;
+    }
+    othello_server_lobby_players = players;
+    othello_server_lobby_players_capacity = capacity;
+  }
+
+  othello_server_lobby_players[othello_server_lobby_players_count] = player;
+  __atomic_add_fetch(&othello_server_lobby_players_count, 1, __ATOMIC_RELAXED);
+  player->lobby = true;
+
+  pthread_mutex_unlock(&othello_server_lobby_players_mutex);
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ * once it returns, the lobby thread does not use the player anymore
+ */
+othello_status_t othello_lobby_unsubscribe(othello_player_t *player) {
+  othello_player_t **player_cursor;
+
+  pthread_mutex_lock(&othello_server_lobby_players_mutex);
+
+  if (!player->lobby) {
+    pthread_mutex_unlock(&othello_server_lobby_players_mutex);
+    return OTHELLO_FAILURE;
+  }
+
+  for (player_cursor = othello_server_lobby_players;
+       *player_cursor != player; player_cursor++)
+    ;
+  *player_cursor =
+      othello_server_lobby_players[othello_server_lobby_players_count - 1];
+  __atomic_sub_fetch(&othello_server_lobby_players_count, 1, __ATOMIC_RELAXED);
+  player->lobby = false;
+
+  pthread_mutex_unlock(&othello_server_lobby_players_mutex);
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ * wait for the first event of a tick, let the tick gather the next ones, then
+ * send them with one write per subscriber, a tick larger than the output of a
+ * player is sent by chunks of whole events that each fit in it
+ */
+void *othello_lobby_start(void *arg) {
+  char *events;
+  char *swap;
+  size_t events_length, events_capacity, swap_capacity, chunk, offset;
+  struct timespec tick;
+  othello_player_t **player_cursor;
+
+  events = NULL;
+  events_capacity = 0;
+  chunk = othello_server_output_length -
+          othello_server_output_length % OTHELLO_LOBBY_EVENT_LENGTH;
+  tick.tv_sec = othello_server_lobby_tick / 1000;
+  tick.tv_nsec = othello_server_lobby_tick % 1000 * 1000000;
+
+  for (;;) {
+    pthread_mutex_lock(&othello_server_lobby_events_mutex);
+    while (othello_server_lobby_events_length == 0) {
+      pthread_cond_wait(&othello_server_lobby_events_cond,
+                        &othello_server_lobby_events_mutex);
+    }
+    pthread_mutex_unlock(&othello_server_lobby_events_mutex);
+
+    nanosleep(&tick, NULL);
+
+    /*swap the buffers, the producers fill the other one meanwhile*/
+    pthread_mutex_lock(&othello_server_lobby_events_mutex);
+    events_length = othello_server_lobby_events_length;
+    swap = events;
+    swap_capacity = events_capacity;
+    events = othello_server_lobby_events;
+    events_capacity = othello_server_lobby_events_capacity;
+    othello_server_lobby_events = swap;
+    othello_server_lobby_events_capacity = swap_capacity;
+    othello_server_lobby_events_length = 0;
+    pthread_mutex_unlock(&othello_server_lobby_events_mutex);
+
+    pthread_mutex_lock(&othello_server_lobby_players_mutex);
+    for (player_cursor = othello_server_lobby_players;
+         player_cursor <
+         othello_server_lobby_players + othello_server_lobby_players_count;
+         player_cursor++) {
+      /*a subscriber disconnected by an overflow gets no more chunks*/
+      for (offset = 0; offset < events_length; offset += chunk) {
+        if (othello_player_send(*player_cursor, events + offset,
+                                events_length - offset < chunk
+                                    ? events_length - offset
+                                    : chunk) != OTHELLO_SUCCESS) {
+          break;
+        }
+      }
+    }
+    pthread_mutex_unlock(&othello_server_lobby_players_mutex);
+  }
+
+  return NULL;
+}
+
+/**
+ *
+ */
+int othello_lobby_init(void) {
+  int status;
+  pthread_t thread;
+
+  othello_server_lobby_players = NULL;
+  othello_server_lobby_players_count = 0;
+  othello_server_lobby_players_capacity = 0;
+  othello_server_lobby_events = NULL;
+  othello_server_lobby_events_length = 0;
+  othello_server_lobby_events_capacity = 0;
+
+  if ((status = pthread_mutex_init(&othello_server_lobby_players_mutex,
+                                   NULL)) ||
+      (status = pthread_mutex_init(&othello_server_lobby_events_mutex,
+                                   NULL)) ||
+      (status = pthread_cond_init(&othello_server_lobby_events_cond, NULL)) ||
+      (status = pthread_create(&thread, NULL, othello_lobby_start, NULL)) ||
+      (status = pthread_detach(thread))) {
+    errno = status;
+    return -status;
+  }
+
+  return 0;
+}
+
+/**
+ *
+ */
+void othello_room_list_release(othello_room_list_t *room_list) {
+  pthread_mutex_lock(&othello_server_room_list_mutex);
+  if (--room_list->references == 0) {
+    free(room_list);
+  }
+  pthread_mutex_unlock(&othello_server_room_list_mutex);
+}
+
+/**
+ * the room mutex is taken before the rooms mutex is given back, so the room
+ * can't be freed before the caller adds itself to the room
+ */
+othello_room_t *othello_room_acquire(unsigned short room_id) {
+  othello_rooms_page_t **page;
+  othello_room_t **room;
+  othello_room_t *room_locked;
+
+  if (room_id >= othello_server_rooms_length) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&othello_server_rooms_mutex);
+
+  page = othello_server_rooms + room_id / OTHELLO_ROOMS_PAGE_LENGTH;
+  if (*page == NULL &&
+      (*page = calloc(1, sizeof(othello_rooms_page_t))) == NULL) {
+    pthread_mutex_unlock(&othello_server_rooms_mutex);
+    return NULL;
+  }
+
+  room = (*page)->rooms + room_id % OTHELLO_ROOMS_PAGE_LENGTH;
+  if (*room == NULL) {
+    if ((*room = calloc(1, sizeof(othello_room_t))) == NULL ||
+        pthread_mutex_init(&((*room)->mutex), NULL)) {
+      free(*room);
+      *room = NULL;
+      if ((*page)->rooms_count == 0) {
+        free(*page);
+        *page = NULL;
+      }
+      pthread_mutex_unlock(&othello_server_rooms_mutex);
+      return NULL;
+    }
+    (*room)->id = room_id;
+    (*page)->rooms_count++;
+    othello_metrics_gauge(OTHELLO_METRICS_ROOMS, 1);
+  }
+
+  room_locked = *room;
+  OTHELLO_ROOM_LOCK(room_locked);
+
+  pthread_mutex_unlock(&othello_server_rooms_mutex);
+
+  return room_locked;
+}
+
+/**
+ * the room is found again by its id, another player may have joined then
+ * released it since the caller left it
+ */
+void othello_room_release(unsigned short room_id) {
+  othello_rooms_page_t **page;
+  othello_room_t *room;
+  othello_player_t **player_cursor;
+  bool empty;
+
+  pthread_mutex_lock(&othello_server_rooms_mutex);
+
+  page = othello_server_rooms + room_id / OTHELLO_ROOMS_PAGE_LENGTH;
+  if (*page == NULL ||
+      (room = (*page)->rooms[room_id % OTHELLO_ROOMS_PAGE_LENGTH]) == NULL) {
+    pthread_mutex_unlock(&othello_server_rooms_mutex);
+    return;
+  }
+
+  empty = true;
+  OTHELLO_ROOM_LOCK(room);
+  for (player_cursor = room->players;
+       player_cursor < room->players + OTHELLO_ROOM_LENGTH; player_cursor++) {
+    if (*player_cursor != NULL) {
+      empty = false;
+    }
+  }
+  OTHELLO_ROOM_UNLOCK(room);
+
+  if (empty) {
+    (*page)->rooms[room_id % OTHELLO_ROOMS_PAGE_LENGTH] = NULL;
+    if (--(*page)->rooms_count == 0) {
+      free(*page);
+      *page = NULL;
+    }
+    pthread_mutex_destroy(&(room->mutex));
+    free(room);
+    othello_metrics_gauge(OTHELLO_METRICS_ROOMS, -1);
+  }
+
+  pthread_mutex_unlock(&othello_server_rooms_mutex);
+}
+
+/**
+ *
+ */
+othello_status_t othello_handle_room_join(othello_player_t *player) {
+  othello_status_t status;
+  char request[OTHELLO_ROOM_ID_LENGTH];
+  unsigned short room_id;
+  char reply[2];
+  char notif[1 + OTHELLO_PLAYER_NAME_LENGTH];
+  othello_room_t *room;
+  othello_player_t **player_cursor;
+
+  status = OTHELLO_SUCCESS;
+
+  reply[0] = OTHELLO_QUERY_ROOM_JOIN;
+  reply[1] = OTHELLO_FAILURE;
+
+  notif[0] = OTHELLO_NOTIF_ROOM_JOIN;
+
+  if (othello_player_read(player, request, sizeof(request)) <= 0) {
+    status = OTHELLO_FAILURE;
+  }
+  room_id = OTHELLO_ROOM_ID_GET(request);
+
+  if (status == OTHELLO_SUCCESS && player->state == OTHELLO_STATE_CONNECTED &&
+      (room = othello_room_acquire(room_id)) != NULL) {
+
+    for (player_cursor = room->players;
+         player_cursor < room->players + OTHELLO_ROOM_LENGTH; player_cursor++) {
+      if (*player_cursor == NULL) {
+        *player_cursor = player;
+        player->room = room;
+        player->state = OTHELLO_STATE_IN_ROOM;
+        player->ready = false;
+        break;
+      }
+    }
+    if (player->room != NULL) {
+      reply[1] = OTHELLO_SUCCESS;
+      memcpy(notif + 1, player->name, OTHELLO_PLAYER_NAME_LENGTH);
+      __atomic_add_fetch(&othello_server_rooms_version, 1, __ATOMIC_RELEASE);
+      othello_lobby_push(room_id, OTHELLO_LOBBY_ROOM_JOIN, player->name);
+      othello_journal_append(OTHELLO_JOURNAL_ROOM_JOIN, player->number, room_id,
+                             0, player->name);
+
+      for (player_cursor = room->players;
+           player_cursor < room->players + OTHELLO_ROOM_LENGTH;
+           player_cursor++) {
+        if (*player_cursor != NULL && *player_cursor != player) {
+          othello_player_send(*player_cursor, notif, sizeof(notif));
+        }
+      }
+    }
+    OTHELLO_ROOM_UNLOCK(room);
+
+    othello_log(LOG_INFO, "player %p %d %s - join room: %d", player,
+                player->socket, player->name, room_id);
+  }
+
+  if (othello_player_send(player, reply, sizeof(reply)) != OTHELLO_SUCCESS) {
+    status = OTHELLO_FAILURE;
+  }
+
+  return status;
+}
+
+/**
+ *
+ */
+othello_status_t othello_handle_room_leave(othello_player_t *player) {
+  othello_status_t status;
+  char reply[2];
+  char notif[1 + OTHELLO_PLAYER_NAME_LENGTH];
+  othello_player_t **player_cursor;
+  unsigned short room_id;
+
+  status = OTHELLO_SUCCESS;
+
+  reply[0] = OTHELLO_QUERY_ROOM_LEAVE;
+  reply[1] = OTHELLO_FAILURE;
+
+  notif[0] = OTHELLO_NOTIF_ROOM_LEAVE;
+
+  if (player->state == OTHELLO_STATE_IN_ROOM) {
+    reply[1] = OTHELLO_SUCCESS;
+    memcpy(notif + 1, player->name, OTHELLO_PLAYER_NAME_LENGTH);
+    room_id = player->room->id;
+
+    OTHELLO_ROOM_LOCK(player->room);
+    for (player_cursor = player->room->players;
+         player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
+         player_cursor++) {
+      if (*player_cursor == player) {
+        *player_cursor = NULL;
+        __atomic_add_fetch(&othello_server_rooms_version, 1, __ATOMIC_RELEASE);
+        othello_lobby_push(room_id, OTHELLO_LOBBY_ROOM_LEAVE, player->name);
+        othello_journal_append(OTHELLO_JOURNAL_ROOM_LEAVE, player->number,
+                               room_id, 0, player->name);
+      } else if (*player_cursor != NULL) {
+        othello_player_send(*player_cursor, notif, sizeof(notif));
+      }
+    }
+    OTHELLO_ROOM_UNLOCK(player->room);
+
+    othello_room_release(room_id);
+    player->room = NULL;
+    player->state = OTHELLO_STATE_CONNECTED;
 
     othello_log(LOG_INFO, "player %p %d %s - leave room", player,
                 player->socket, player->name);
   }
 
-  pthread_mutex_lock(&(player->mutex));
-  if (othello_write_all(player->socket, reply, sizeof(reply)) <= 0) {
+  if (othello_player_send(player, reply, sizeof(reply)) != OTHELLO_SUCCESS) {
     status = OTHELLO_FAILURE;
   }
-  pthread_mutex_unlock(&(player->mutex));
 
   return status;
 }
@@ -399,8 +1294,8 @@ othello_status_t othello_handle_message(othello_player_t *player) {
   notif[0] = OTHELLO_NOTIF_MESSAGE;
   memcpy(notif + 1, player->name, OTHELLO_PLAYER_NAME_LENGTH);
 
-  if (othello_read_all(player->socket, notif + 1 + OTHELLO_PLAYER_NAME_LENGTH,
-                       OTHELLO_MESSAGE_LENGTH) <= 0) {
+  if (othello_player_read(player, notif + 1 + OTHELLO_PLAYER_NAME_LENGTH,
+                          OTHELLO_MESSAGE_LENGTH) <= 0) {
     status = OTHELLO_FAILURE;
   }
 
@@ -408,28 +1303,24 @@ othello_status_t othello_handle_message(othello_player_t *player) {
                                     player->state == OTHELLO_STATE_IN_GAME)) {
     reply[1] = OTHELLO_SUCCESS;
 
-    pthread_mutex_lock(&(player->room->mutex));
+    OTHELLO_ROOM_LOCK(player->room);
     for (player_cursor = player->room->players;
          player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
          player_cursor++) {
       if (*player_cursor != NULL && *player_cursor != player) {
-        pthread_mutex_lock(&((*player_cursor)->mutex));
-        othello_write_all((*player_cursor)->socket, notif, sizeof(notif));
-        pthread_mutex_unlock(&((*player_cursor)->mutex));
+        othello_player_send(*player_cursor, notif, sizeof(notif));
       }
     }
-    pthread_mutex_unlock(&(player->room->mutex));
+    OTHELLO_ROOM_UNLOCK(player->room);
 
-    othello_log(LOG_INFO, "player %p %d %s - message: %s", player,
-                player->socket, player->name,
+    othello_log(LOG_INFO, "player %p %d %s - message: %.*s", player,
+                player->socket, player->name, OTHELLO_MESSAGE_LENGTH,
                 notif + 1 + OTHELLO_PLAYER_NAME_LENGTH);
   }
 
-  pthread_mutex_lock(&(player->mutex));
-  if (othello_write_all(player->socket, reply, sizeof(reply)) <= 0) {
+  if (othello_player_send(player, reply, sizeof(reply)) != OTHELLO_SUCCESS) {
     status = OTHELLO_FAILURE;
   }
-  pthread_mutex_unlock(&(player->mutex));
 
   return status;
 }
@@ -441,9 +1332,11 @@ othello_status_t othello_handle_ready(othello_player_t *player) {
   othello_status_t status;
   char reply[2];
   char notif_ready[1 + OTHELLO_PLAYER_NAME_LENGTH];
-  char notif_start[2];
+  char notif_start[OTHELLO_ROOM_LENGTH][2];
+  othello_batch_t batches[OTHELLO_ROOM_LENGTH];
+  othello_batch_t *batch_cursor;
   othello_player_t **player_cursor;
-  int players_ready;
+  int players_ready, side;
 
   status = OTHELLO_SUCCESS;
 
@@ -451,7 +1344,6 @@ othello_status_t othello_handle_ready(othello_player_t *player) {
   reply[1] = OTHELLO_FAILURE;
 
   notif_ready[0] = OTHELLO_NOTIF_READY;
-  notif_start[0] = OTHELLO_NOTIF_GAME_START;
 
   if (player->state == OTHELLO_STATE_IN_ROOM && !player->ready) {
     reply[1] = OTHELLO_SUCCESS;
@@ -462,67 +1354,68 @@ othello_status_t othello_handle_ready(othello_player_t *player) {
     othello_log(LOG_INFO, "player %p %d %s - ready", player, player->socket,
                 player->name);
 
-    /*send notif ready to other players*/
-    pthread_mutex_lock(&(player->room->mutex));
-    for (player_cursor = player->room->players;
+    /*reply to the player, notif ready to other players*/
+    OTHELLO_ROOM_LOCK(player->room);
+    for (player_cursor = player->room->players, batch_cursor = batches;
          player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
-         player_cursor++) {
-      if (*player_cursor != NULL && *player_cursor != player) {
+         player_cursor++, batch_cursor++) {
+      othello_batch_init(batch_cursor, *player_cursor);
+      if (*player_cursor == player) {
+        othello_batch_add(batch_cursor, reply, sizeof(reply));
+      } else if (*player_cursor != NULL) {
         if ((*player_cursor)->ready) {
           players_ready++;
         }
-        pthread_mutex_lock(&((*player_cursor)->mutex));
-        othello_write_all((*player_cursor)->socket, notif_ready,
-                          sizeof(notif_ready));
-        pthread_mutex_unlock(&((*player_cursor)->mutex));
+        othello_batch_add(batch_cursor, notif_ready, sizeof(notif_ready));
       }
     }
 
-    pthread_mutex_lock(&(player->mutex));
-    if (othello_write_all(player->socket, &reply, sizeof(reply)) <= 0) {
-      status = OTHELLO_FAILURE;
-    }
-    pthread_mutex_unlock(&(player->mutex));
+    othello_lobby_push(player->room->id, OTHELLO_LOBBY_READY, player->name);
+    othello_journal_append(OTHELLO_JOURNAL_READY, player->number,
+                           player->room->id, 0, player->name);
 
     othello_log(LOG_INFO, "room %p - %d/%d ready", player->room, players_ready,
                 OTHELLO_ROOM_LENGTH);
 
     if (players_ready == OTHELLO_ROOM_LENGTH) {
-      memset(player->room->grid, 0, sizeof(player->room->grid));
+      othello_board_init(&(player->room->board));
+      for (side = 0; side < OTHELLO_ROOM_LENGTH; side++) {
+        player->room->scores[side] =
+            othello_board_score(&(player->room->board), side);
+      }
+
+      othello_lobby_push(player->room->id, OTHELLO_LOBBY_GAME_START, NULL);
+      othello_metrics_gauge(OTHELLO_METRICS_GAMES, 1);
+      othello_journal_append(OTHELLO_JOURNAL_GAME_START, player->number,
+                             player->room->id, 0, player->name);
 
       othello_log(LOG_INFO, "room %p - game start", player->room);
 
-      for (player_cursor = player->room->players;
+      for (player_cursor = player->room->players, batch_cursor = batches;
            player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
-           player_cursor++) {
+           player_cursor++, batch_cursor++) {
         if (*player_cursor != NULL) {
-          if (player_cursor == player->room->players) {
-            notif_start[1] = true; /* first player of the room start to play */
-
-            player->room->grid[4][3] = *player_cursor;
-            player->room->grid[3][4] = *player_cursor;
+          side = player_cursor - player->room->players;
+          notif_start[side][0] = OTHELLO_NOTIF_GAME_START;
+          if (side == 0) {
+            notif_start[side][1] = true; /* first player of the room start */
           } else {
-            notif_start[1] = false;
+            notif_start[side][1] = false;
             (*player_cursor)->ready = false; /* can't play */
-
-            player->room->grid[3][3] = *player_cursor;
-            player->room->grid[4][4] = *player_cursor;
           }
           (*player_cursor)->state = OTHELLO_STATE_IN_GAME;
-          pthread_mutex_lock(&((*player_cursor)->mutex));
-          othello_write_all((*player_cursor)->socket, notif_start,
-                            sizeof(notif_start));
-          pthread_mutex_unlock(&((*player_cursor)->mutex));
+          othello_batch_add(batch_cursor, notif_start[side],
+                            sizeof(notif_start[side]));
         }
       }
     }
-    pthread_mutex_unlock(&(player->room->mutex));
+
+    status = othello_room_flush(batches, player);
+    OTHELLO_ROOM_UNLOCK(player->room);
   } else {
-    pthread_mutex_lock(&(player->mutex));
-    if (othello_write_all(player->socket, &reply, sizeof(reply)) <= 0) {
+    if (othello_player_send(player, &reply, sizeof(reply)) != OTHELLO_SUCCESS) {
       status = OTHELLO_FAILURE;
     }
-    pthread_mutex_unlock(&(player->mutex));
   }
 
   return status;
@@ -546,28 +1439,28 @@ othello_status_t othello_handle_not_ready(othello_player_t *player) {
     player->ready = false;
     memcpy(notif_not_ready + 1, player->name, OTHELLO_PLAYER_NAME_LENGTH);
 
-    pthread_mutex_lock(&(player->room->mutex));
+    OTHELLO_ROOM_LOCK(player->room);
     for (player_cursor = player->room->players;
          player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
          player_cursor++) {
       if (*player_cursor != NULL && *player_cursor != player) {
-        pthread_mutex_lock(&((*player_cursor)->mutex));
-        othello_write_all((*player_cursor)->socket, notif_not_ready,
-                          sizeof(notif_not_ready));
-        pthread_mutex_unlock(&((*player_cursor)->mutex));
+        othello_player_send(*player_cursor, notif_not_ready,
+                            sizeof(notif_not_ready));
       }
     }
-    pthread_mutex_unlock(&(player->room->mutex));
+    othello_lobby_push(player->room->id, OTHELLO_LOBBY_NOT_READY,
+                       player->name);
+    othello_journal_append(OTHELLO_JOURNAL_NOT_READY, player->number,
+                           player->room->id, 0, player->name);
+    OTHELLO_ROOM_UNLOCK(player->room);
 
     othello_log(LOG_INFO, "%p %d %s - not ready", player, player->socket,
                 player->name);
   }
 
-  pthread_mutex_lock(&(player->mutex));
-  if (othello_write_all(player->socket, &reply, sizeof(reply)) <= 0) {
+  if (othello_player_send(player, &reply, sizeof(reply)) != OTHELLO_SUCCESS) {
     status = OTHELLO_FAILURE;
   }
-  pthread_mutex_unlock(&(player->mutex));
 
   return status;
 }
@@ -580,25 +1473,29 @@ othello_status_t othello_handle_play(othello_player_t *player) {
   unsigned char stroke[2];
   char reply[2];
   char notif_play[3];
-  char notif_end[2];
+  char notif_end[OTHELLO_ROOM_LENGTH][4];
   char notif_your_turn[1];
+  othello_batch_t batches[OTHELLO_ROOM_LENGTH];
+  othello_batch_t *batch_cursor;
+  othello_batch_t *batch_turn;
   othello_player_t **player_cursor;
   othello_player_t **player_next;
   othello_player_t *player_winner;
   othello_player_t *player_turn;
-  int best_score, score;
+  int best_score, score, total_score, side;
+  bool finished;
 
   status = OTHELLO_SUCCESS;
+  player_next = NULL; /*set when the player is found in its room*/
 
   reply[0] = OTHELLO_QUERY_PLAY;
   reply[1] = OTHELLO_FAILURE;
 
   notif_play[0] = OTHELLO_NOTIF_PLAY;
-  notif_end[0] = OTHELLO_NOTIF_GAME_END;
 
   notif_your_turn[0] = OTHELLO_NOTIF_YOUR_TURN;
 
-  if (othello_read_all(player->socket, stroke, sizeof(stroke)) <= 0) {
+  if (othello_player_read(player, stroke, sizeof(stroke)) <= 0) {
     status = OTHELLO_FAILURE;
   }
 
@@ -608,58 +1505,67 @@ othello_status_t othello_handle_play(othello_player_t *player) {
     othello_log(LOG_INFO, "player %p %d %s - play: [%d,%d]", player,
                 player->socket, player->name, stroke[0], stroke[1]);
 
-    pthread_mutex_lock(&(player->room->mutex));
+    /*the frames of every player are gathered then flushed once per player*/
+    OTHELLO_ROOM_LOCK(player->room);
+    for (player_cursor = player->room->players, batch_cursor = batches;
+         player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
+         player_cursor++, batch_cursor++) {
+      othello_batch_init(batch_cursor, *player_cursor);
+    }
+
     if (othello_game_play_stroke(player, stroke[0], stroke[1]) ==
         OTHELLO_SUCCESS) {
       reply[1] = OTHELLO_SUCCESS;
       player->ready = false;
-    }
-    pthread_mutex_unlock(&(player->room->mutex));
-
-    pthread_mutex_lock(&(player->mutex));
-    if (othello_write_all(player->socket, reply, sizeof(reply)) <= 0) {
-      status = OTHELLO_FAILURE;
-    }
-    pthread_mutex_unlock(&(player->mutex));
-
-    /*invalid stroke*/
-    if (reply[1] != OTHELLO_SUCCESS) {
-      return status;
+      othello_journal_append(OTHELLO_JOURNAL_PLAY, player->number,
+                             player->room->id,
+                             OTHELLO_BOARD_SQUARE(stroke[0], stroke[1]),
+                             player->name);
     }
 
     /*notify stroke*/
     memcpy(notif_play + 1, stroke, sizeof(stroke));
 
-    pthread_mutex_lock(&(player->room->mutex));
-    for (player_cursor = player->room->players;
+    for (player_cursor = player->room->players, batch_cursor = batches;
          player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
-         player_cursor++) {
+         player_cursor++, batch_cursor++) {
       if (*player_cursor == player) {
         player_next = player_cursor + 1;
-      } else if (*player_cursor != NULL) {
-        pthread_mutex_lock(&((*player_cursor)->mutex));
-        othello_write_all((*player_cursor)->socket, notif_play,
-                          sizeof(notif_play));
-        pthread_mutex_unlock(&((*player_cursor)->mutex));
+        othello_batch_add(batch_cursor, reply, sizeof(reply));
+      } else if (reply[1] == OTHELLO_SUCCESS) {
+        othello_batch_add(batch_cursor, notif_play, sizeof(notif_play));
       }
     }
 
+    /*invalid stroke*/
+    if (reply[1] != OTHELLO_SUCCESS) {
+      status = othello_room_flush(batches, player);
+      OTHELLO_ROOM_UNLOCK(player->room);
+      return status;
+    }
+
     /*find next player or winner if game is over*/
     player_winner = player;
     player_turn = NULL;
+    batch_turn = NULL;
+    best_score = -1;
+    total_score = 0;
+    finished = othello_game_is_finished(player);
     player_cursor = player_next;
     do {
       if (player_cursor >= player->room->players + OTHELLO_ROOM_LENGTH) {
         player_cursor = player->room->players;
       }
-      if (othello_game_able_to_play(*player_cursor)) {
+      if (!finished && othello_game_able_to_play(*player_cursor)) {
         player_turn = *player_cursor;
+        batch_turn = batches + (player_cursor - player->room->players);
         break;
       }
       if ((score = othello_game_score(*player_cursor)) > best_score) {
         player_winner = *player_cursor;
         best_score = score;
       }
+      total_score += score;
 
       player_cursor++;
     } while (player_cursor != player_next);
@@ -667,24 +1573,35 @@ othello_status_t othello_handle_play(othello_player_t *player) {
     /*game over*/
     if (player_turn == NULL) {
       othello_log(LOG_INFO, "room %p - game over: winner: %p %d %s",
-                  player->room, player, player->socket, player->name);
+                  player->room, player_winner, player_winner->socket,
+                  player_winner->name);
 
-      for (player_cursor = player->room->players;
+      othello_lobby_push(player->room->id, OTHELLO_LOBBY_GAME_END,
+                         player_winner->name);
+      othello_metrics_gauge(OTHELLO_METRICS_GAMES, -1);
+      othello_journal_append(OTHELLO_JOURNAL_GAME_END, player_winner->number,
+                             player->room->id, othello_game_side(player_winner),
+                             player_winner->name);
+
+      for (player_cursor = player->room->players, batch_cursor = batches;
            player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
-           player_cursor++) {
+           player_cursor++, batch_cursor++) {
         if (*player_cursor != NULL) {
           (*player_cursor)->ready = false;
           (*player_cursor)->state = OTHELLO_STATE_IN_ROOM;
 
+          side = player_cursor - player->room->players;
+          notif_end[side][0] = OTHELLO_NOTIF_GAME_END;
           if (*player_cursor == player_winner) {
-            notif_end[1] = true;
+            notif_end[side][1] = true;
           } else {
-            notif_end[1] = false;
+            notif_end[side][1] = false;
           }
-          pthread_mutex_lock(&((*player_cursor)->mutex));
-          othello_write_all((*player_cursor)->socket, notif_end,
-                            sizeof(notif_end));
-          pthread_mutex_unlock(&((*player_cursor)->mutex));
+          /*discs of the player then discs of the opponents*/
+          notif_end[side][2] = othello_game_score(*player_cursor);
+          notif_end[side][3] = total_score - notif_end[side][2];
+          othello_batch_add(batch_cursor, notif_end[side],
+                            sizeof(notif_end[side]));
         }
       }
     } else {
@@ -692,135 +1609,789 @@ othello_status_t othello_handle_play(othello_player_t *player) {
                   player->room, player, player->socket, player->name);
 
       player_turn->ready = true;
-      pthread_mutex_lock(&(player_turn->mutex));
-      othello_write_all(player_turn->socket, notif_your_turn,
-                        sizeof(notif_your_turn));
-      pthread_mutex_unlock(&(player_turn->mutex));
+      othello_batch_add(batch_turn, notif_your_turn, sizeof(notif_your_turn));
     }
 
-    pthread_mutex_unlock(&(player->room->mutex));
+    status = othello_room_flush(batches, player);
+
+    OTHELLO_ROOM_UNLOCK(player->room);
   } else {
-    pthread_mutex_lock(&(player->mutex));
-    if (othello_write_all(player->socket, reply, sizeof(reply)) <= 0) {
+    if (othello_player_send(player, reply, sizeof(reply)) != OTHELLO_SUCCESS) {
       status = OTHELLO_FAILURE;
     }
-    pthread_mutex_unlock(&(player->mutex));
   }
-
-  return status;
+
+  return status;
+}
+
+/**
+ *
+ */
+othello_status_t othello_handle_give_up(othello_player_t *player) {
+  othello_status_t status;
+  char reply[2];
+  char notif[1 + OTHELLO_PLAYER_NAME_LENGTH];
+  othello_player_t **player_cursor;
+
+  status = OTHELLO_SUCCESS;
+
+  reply[0] = OTHELLO_QUERY_GIVE_UP;
+  reply[1] = OTHELLO_FAILURE;
+
+  notif[0] = OTHELLO_NOTIF_GIVE_UP;
+
+  if (player->state == OTHELLO_STATE_IN_GAME) {
+    reply[1] = OTHELLO_SUCCESS;
+    memcpy(notif + 1, player->name, sizeof(player->name));
+
+    OTHELLO_ROOM_LOCK(player->room);
+    for (player_cursor = player->room->players;
+         player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
+         player_cursor++) {
+      if (*player_cursor != NULL) {
+        if (*player_cursor != player) {
+          othello_player_send(*player_cursor, notif, sizeof(notif));
+        }
+        (*player_cursor)->ready = false;
+        (*player_cursor)->state = OTHELLO_STATE_IN_ROOM;
+      }
+    }
+    othello_lobby_push(player->room->id, OTHELLO_LOBBY_GAME_END, NULL);
+    othello_metrics_gauge(OTHELLO_METRICS_GAMES, -1);
+    othello_journal_append(OTHELLO_JOURNAL_GIVE_UP, player->number,
+                           player->room->id, othello_game_side(player),
+                           player->name);
+    OTHELLO_ROOM_UNLOCK(player->room);
+
+    othello_log(LOG_INFO, "player %p %d %s - give up", player, player->socket,
+                player->name);
+  }
+
+  if (othello_player_send(player, &reply, sizeof(reply)) != OTHELLO_SUCCESS) {
+    status = OTHELLO_FAILURE;
+  }
+
+  return status;
+}
+
+/**
+ * the initial state is given by the room list, the events are idempotent on
+ * a set of players per room so the client may ask for it once subscribed
+ */
+othello_status_t othello_handle_lobby(othello_player_t *player) {
+  othello_status_t status;
+  char subscribe;
+  char reply[2];
+
+  status = OTHELLO_SUCCESS;
+
+  reply[0] = OTHELLO_QUERY_LOBBY;
+  reply[1] = OTHELLO_FAILURE;
+
+  if (othello_player_read(player, &subscribe, sizeof(subscribe)) <= 0) {
+    return OTHELLO_FAILURE;
+  }
+
+  if (player->state != OTHELLO_STATE_NOT_CONNECTED) {
+    if (subscribe) {
+      reply[1] = othello_lobby_subscribe(player);
+    } else {
+      reply[1] = othello_lobby_unsubscribe(player);
+    }
+
+    othello_log(LOG_INFO, "player %p %d %s - lobby: %s", player,
+                player->socket, player->name,
+                subscribe ? "subscribe" : "unsubscribe");
+  }
+
+  if (othello_player_send(player, reply, sizeof(reply)) != OTHELLO_SUCCESS) {
+    status = OTHELLO_FAILURE;
+  }
+
+  return status;
+}
+
+/**
+ *
+ */
+ssize_t othello_query_length(char query) {
+  switch (query) {
+  case OTHELLO_QUERY_LOGIN:
+    return 1 + OTHELLO_PLAYER_NAME_LENGTH;
+  case OTHELLO_QUERY_ROOM_LIST:
+  case OTHELLO_QUERY_ROOM_JOIN:
+    return OTHELLO_ROOM_ID_LENGTH;
+  case OTHELLO_QUERY_MESSAGE:
+    return OTHELLO_MESSAGE_LENGTH;
+  case OTHELLO_QUERY_PLAY:
+    return 2;
+  case OTHELLO_QUERY_LOBBY:
+    return 1;
+  case OTHELLO_QUERY_ROOM_LEAVE:
+  case OTHELLO_QUERY_READY:
+  case OTHELLO_QUERY_NOT_READY:
+  case OTHELLO_QUERY_GIVE_UP:
+    return 0;
+  case OTHELLO_QUERY_LOGOFF:;
+  default:
+    return -1;
+  }
+}
+
+/**
+ *
+ */
+othello_status_t othello_player_handle(othello_player_t *player, char query) {
+  othello_status_t status;
+  struct timespec start;
+
+  othello_metrics_query_begin(player, &start);
+
+  switch (query) {
+  case OTHELLO_QUERY_LOGIN:
+    status = othello_handle_login(player);
+    break;
+  case OTHELLO_QUERY_ROOM_LIST:
+    status = othello_handle_room_list(player);
+    break;
+  case OTHELLO_QUERY_ROOM_JOIN:
+    status = othello_handle_room_join(player);
+    break;
+  case OTHELLO_QUERY_ROOM_LEAVE:
+    status = othello_handle_room_leave(player);
+    break;
+  case OTHELLO_QUERY_MESSAGE:
+    status = othello_handle_message(player);
+    break;
+  case OTHELLO_QUERY_READY:
+    status = othello_handle_ready(player);
+    break;
+  case OTHELLO_QUERY_NOT_READY:
+    status = othello_handle_not_ready(player);
+    break;
+  case OTHELLO_QUERY_PLAY:
+    status = othello_handle_play(player);
+    break;
+  case OTHELLO_QUERY_GIVE_UP:
+    status = othello_handle_give_up(player);
+    break;
+  case OTHELLO_QUERY_LOBBY:
+    status = othello_handle_lobby(player);
+    break;
+  case OTHELLO_QUERY_LOGOFF:;
+  default:
+    status = OTHELLO_FAILURE;
+    break;
+  }
+
+  othello_metrics_query_end(query, &start, status);
+
+  return status;
+}
+
+/**
+ *
+ */
+othello_player_t *othello_player_new(int socket) {
+  othello_player_t *player;
+  int one;
+
+  /*the pool holds as many slots as the players limit*/
+  if ((player = othello_pool_get(&othello_server_players)) == NULL) {
+    othello_log(LOG_WARNING, "%d - connection refused: server full", socket);
+    return NULL;
+  }
+
+  one = 1;
+  memset(player, 0, sizeof(othello_player_t));
+  if (pthread_mutex_init(&(player->mutex), NULL)) {
+    othello_pool_put(&othello_server_players, player);
+    return NULL;
+  }
+  player->socket = socket;
+  player->number =
+      __atomic_add_fetch(&othello_server_players_number, 1, __ATOMIC_RELAXED);
+
+  /*each event is flushed at once, do not wait for the ack of the previous*/
+  setsockopt(player->socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  othello_metrics_gauge(OTHELLO_METRICS_CONNECTIONS, 1);
+
+  othello_log(LOG_INFO, "%p %d %s - connect: %u/%u players", player,
+              player->socket, player->name,
+              othello_pool_used(&othello_server_players),
+              othello_server_players_length);
+
+  return player;
+}
+
+/**
+ * the socket is blocking, each read waits for at least one byte then takes
+ * every query already received
+ */
+void *othello_player_start(void *arg) {
+  othello_player_t *player;
+
+  player = (othello_player_t *)arg;
+
+  while (othello_player_receive(player) == OTHELLO_SUCCESS) {
+  }
+
+  othello_player_end(player);
+
+  return NULL;
+}
+
+/**
+ * buffer the available bytes then handle every complete query
+ */
+othello_status_t othello_player_receive(othello_player_t *player) {
+  ssize_t bytes_read;
+
+  bytes_read = read(player->socket, player->input + player->input_length,
+                    sizeof(player->input) - player->input_length);
+  if (bytes_read == 0) {
+    return OTHELLO_FAILURE;
+  }
+  if (bytes_read < 0) {
+    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+               ? OTHELLO_SUCCESS
+               : OTHELLO_FAILURE;
+  }
+  player->input_length += bytes_read;
+  othello_metrics_count(OTHELLO_METRICS_BYTES_RECEIVED, bytes_read);
+
+  return othello_player_process(player);
+}
+
+/**
+ * a join to a room of another reactor stops the processing, the player and its
+ * remaining bytes are handed off to that reactor which handles the join
+ */
+othello_status_t othello_player_process(othello_player_t *player) {
+  ssize_t length;
+  size_t header, available;
+  char *input;
+  char query;
+  othello_reactor_t *reactor;
+
+  reactor = NULL;
+
+  while (player->input_offset < player->input_length) {
+    input = player->input + player->input_offset;
+    available = player->input_length - player->input_offset;
+    /*the login query is not framed, it carries the protocol version*/
+    header = player->state == OTHELLO_STATE_NOT_CONNECTED
+                 ? 0
+                 : OTHELLO_FRAME_HEADER_LENGTH;
+    if (available < header + 1) {
+      break;
+    }
+    query = input[header];
+    if ((length = othello_query_length(query)) < 0 ||
+        (header > 0 && OTHELLO_FRAME_LENGTH_GET(input) != 1 + length)) {
+      return OTHELLO_FAILURE;
+    }
+    /*wait for the rest of the query*/
+    if (available < header + 1 + (size_t)length) {
+      break;
+    }
+    if (player->reactor != NULL && query == OTHELLO_QUERY_ROOM_JOIN &&
+        player->state == OTHELLO_STATE_CONNECTED &&
+        OTHELLO_ROOM_ID_GET(input + header + 1) <
+            othello_server_rooms_length &&
+        (reactor = othello_room_reactor(
+             OTHELLO_ROOM_ID_GET(input + header + 1))) != player->reactor) {
+      break;
+    }
+    reactor = NULL;
+    player->input_offset += header + 1;
+    if (othello_player_handle(player, query) != OTHELLO_SUCCESS) {
+      return OTHELLO_FAILURE;
+    }
+    /*a payload left unread by its handler is skipped with its frame*/
+    player->input_offset = input - player->input + header + 1 + length;
+  }
+
+  memmove(player->input, player->input + player->input_offset,
+          player->input_length - player->input_offset);
+  player->input_length -= player->input_offset;
+  player->input_offset = 0;
+
+  if (reactor != NULL) {
+    return othello_reactor_hand_off(reactor, player);
+  }
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ * the input is copied by parts since a provided buffer holds more bytes than
+ * it, once a hand off stops the processing the rest waits in the backlog like
+ * the bytes left in the socket by the epoll reactors
+ */
+othello_status_t othello_player_feed(othello_player_t *player,
+                                     const char *buffer, size_t length) {
+  size_t count;
+  char *backlog;
+
+  while (length > 0 && player->hand_off == NULL) {
+    count = sizeof(player->input) - player->input_length;
+    if (count > length) {
+      count = length;
+    }
+    /*the processing leaves less than a query in the input*/
+    if (count == 0) {
+      return OTHELLO_FAILURE;
+    }
+    memcpy(player->input + player->input_length, buffer, count);
+    player->input_length += count;
+    buffer += count;
+    length -= count;
+    if (othello_player_process(player) != OTHELLO_SUCCESS) {
+      return OTHELLO_FAILURE;
+    }
+  }
+
+  if (length == 0) {
+    return OTHELLO_SUCCESS;
+  }
+
+  if (player->backlog_length + length > OTHELLO_BACKLOG_LENGTH ||
+      (backlog = realloc(player->backlog, player->backlog_length + length)) ==
+          NULL) {
+    return OTHELLO_FAILURE;
+  }
+  memcpy(backlog + player->backlog_length, buffer, length);
+  player->backlog = backlog;
+  player->backlog_length += length;
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ * the backlog is taken before it is fed, a new hand off starts another one
+ */
+othello_status_t othello_player_feed_backlog(othello_player_t *player) {
+  othello_status_t status;
+  char *backlog;
+  size_t backlog_length;
+
+  if ((backlog = player->backlog) == NULL) {
+    return OTHELLO_SUCCESS;
+  }
+  backlog_length = player->backlog_length;
+  player->backlog = NULL;
+  player->backlog_length = 0;
+
+  status = othello_player_feed(player, backlog, backlog_length);
+  free(backlog);
+
+  return status;
+}
+
+/**
+ *
+ */
+othello_reactor_t *othello_room_reactor(unsigned short room_id) {
+  return othello_server_reactors + room_id % othello_server_workers;
+}
+
+/**
+ * the player must not be used by the calling reactor anymore on success
+ */
+othello_status_t othello_reactor_hand_off(othello_reactor_t *reactor,
+                                          othello_player_t *player) {
+  if (othello_server_io_uring) {
+    /*sent once the multishot receive of the player is over*/
+    player->hand_off = reactor;
+    return OTHELLO_SUCCESS;
+  }
+
+  if (epoll_ctl(player->reactor->event_fd, EPOLL_CTL_DEL, player->socket,
+                NULL) < 0) {
+    return OTHELLO_FAILURE;
+  }
+
+  return othello_reactor_send(reactor, player);
+}
+
+/**
+ *
+ */
+othello_status_t othello_reactor_send(othello_reactor_t *reactor,
+                                      othello_player_t *player) {
+  player->reactor = reactor;
+  if (othello_write_all(reactor->pipe[1], &player, sizeof(player)) <= 0) {
+    return OTHELLO_FAILURE;
+  }
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ *
+ */
+void othello_reactor_close(othello_reactor_t *reactor,
+                           othello_player_t *player) {
+  if (othello_server_io_uring) {
+    player->closing = true;
+    othello_reactor_settle(reactor, player);
+  } else {
+    othello_player_end(player);
+  }
+}
+
+/**
+ *
+ */
+othello_status_t othello_reactor_add(othello_reactor_t *reactor,
+                                     othello_player_t *player) {
+  struct epoll_event event;
+
+  player->reactor = reactor;
+
+  if (othello_server_io_uring) {
+    return othello_reactor_receive(reactor, player);
+  }
+
+  event.events = EPOLLIN;
+  event.data.ptr = player;
+  if (epoll_ctl(reactor->event_fd, EPOLL_CTL_ADD, player->socket, &event) <
+      0) {
+    return OTHELLO_FAILURE;
+  }
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ *
+ */
+int othello_reactor_init(othello_reactor_t *reactor, unsigned short port) {
+  int status;
+  struct epoll_event event;
+
+  if ((reactor->socket = othello_create_socket_stream(
+           port, othello_server_workers > 1)) < 0) {
+    return reactor->socket;
+  }
+
+  if ((status = listen(reactor->socket, SOMAXCONN)) < 0 ||
+      (status = fcntl(reactor->socket, F_SETFL,
+                      fcntl(reactor->socket, F_GETFL) | O_NONBLOCK)) < 0) {
+    return status;
+  }
+
+  if ((status = pipe2(reactor->pipe, O_CLOEXEC)) < 0 ||
+      (status = fcntl(reactor->pipe[0], F_SETFL, O_NONBLOCK)) < 0) {
+    return status;
+  }
+
+  if (othello_server_io_uring) {
+    if ((status = othello_uring_init(&(reactor->uring))) < 0) {
+      return status;
+    }
+    return othello_reactor_accept(reactor) == OTHELLO_SUCCESS &&
+                   othello_reactor_poll_pipe(reactor) == OTHELLO_SUCCESS
+               ? 0
+               : -1;
+  }
+
+  if ((reactor->event_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+    return reactor->event_fd;
+  }
+
+  event.events = EPOLLIN;
+  event.data.ptr = &(reactor->socket);
+  if ((status = epoll_ctl(reactor->event_fd, EPOLL_CTL_ADD, reactor->socket,
+                          &event)) < 0) {
+    return status;
+  }
+
+  event.data.ptr = reactor->pipe;
+  if ((status = epoll_ctl(reactor->event_fd, EPOLL_CTL_ADD, reactor->pipe[0],
+                          &event)) < 0) {
+    return status;
+  }
+
+  return 0;
+}
+
+/**
+ *
+ */
+void othello_reactor_accepted(othello_reactor_t *reactor, int socket) {
+  othello_player_t *player;
+
+  if ((player = othello_player_new(socket)) == NULL) {
+    close(socket);
+  } else if (othello_reactor_add(reactor, player) != OTHELLO_SUCCESS) {
+    othello_reactor_close(reactor, player);
+  }
+}
+
+/**
+ * handle the join query which made the player move to this reactor, then the
+ * bytes received after it by the previous reactor
+ */
+void othello_reactor_read_pipe(othello_reactor_t *reactor) {
+  othello_player_t *player;
+
+  while (read(reactor->pipe[0], &player, sizeof(player)) == sizeof(player)) {
+    if (othello_reactor_add(reactor, player) != OTHELLO_SUCCESS ||
+        othello_player_process(player) != OTHELLO_SUCCESS ||
+        (othello_server_io_uring &&
+         othello_player_feed_backlog(player) != OTHELLO_SUCCESS)) {
+      othello_reactor_close(reactor, player);
+    } else if (othello_server_io_uring && player->hand_off != NULL) {
+      /*the backlog held a join to yet another reactor*/
+      othello_reactor_settle(reactor, player);
+    }
+  }
+}
+
+/**
+ *
+ */
+othello_status_t othello_reactor_accept(othello_reactor_t *reactor) {
+  struct io_uring_sqe *sqe;
+
+  if ((sqe = othello_uring_prepare(&(reactor->uring), IORING_OP_ACCEPT,
+                                   reactor->socket,
+                                   (uintptr_t) & (reactor->socket))) == NULL) {
+    return OTHELLO_FAILURE;
+  }
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->accept_flags = SOCK_NONBLOCK;
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ *
+ */
+othello_status_t othello_reactor_poll_pipe(othello_reactor_t *reactor) {
+  struct io_uring_sqe *sqe;
+
+  if ((sqe = othello_uring_prepare(&(reactor->uring), IORING_OP_POLL_ADD,
+                                   reactor->pipe[0],
+                                   (uintptr_t)reactor->pipe)) == NULL) {
+    return OTHELLO_FAILURE;
+  }
+  sqe->len = IORING_POLL_ADD_MULTI;
+  sqe->poll32_events = POLLIN;
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ *
+ */
+othello_status_t othello_reactor_receive(othello_reactor_t *reactor,
+                                         othello_player_t *player) {
+  struct io_uring_sqe *sqe;
+
+  if ((sqe = othello_uring_prepare(&(reactor->uring), IORING_OP_RECV,
+                                   player->socket, (uintptr_t)player)) ==
+      NULL) {
+    return OTHELLO_FAILURE;
+  }
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = OTHELLO_URING_BUFFER_GROUP;
+  player->receiving = true;
+
+  return OTHELLO_SUCCESS;
+}
+
+/**
+ * a player is ended or handed off only when no receive of the player is in
+ * flight anymore, the kernel would still reference it otherwise
+ */
+void othello_reactor_settle(othello_reactor_t *reactor,
+                            othello_player_t *player) {
+  struct io_uring_sqe *sqe;
+  othello_reactor_t *hand_off;
+
+  if (player->receiving) {
+    if ((player->closing || player->hand_off != NULL) && !player->canceling &&
+        (sqe = othello_uring_prepare(&(reactor->uring), IORING_OP_ASYNC_CANCEL,
+                                     -1, 0)) != NULL) {
+      sqe->addr = (uintptr_t)player;
+      player->canceling = true;
+    }
+    return;
+  }
+
+  player->canceling = false;
+
+  if (player->closing) {
+    othello_player_end(player);
+  } else if ((hand_off = player->hand_off) != NULL) {
+    player->hand_off = NULL;
+    if (othello_reactor_send(hand_off, player) != OTHELLO_SUCCESS) {
+      othello_player_end(player);
+    }
+  } else if (othello_reactor_receive(reactor, player) != OTHELLO_SUCCESS) {
+    othello_player_end(player);
+  }
 }
 
 /**
- *
+ * the provided buffer is given back at once, the bytes received during a hand
+ * off are copied to the backlog of the player for the next reactor
  */
-othello_status_t othello_handle_give_up(othello_player_t *player) {
-  othello_status_t status;
-  char reply[2];
-  char notif[1 + OTHELLO_PLAYER_NAME_LENGTH];
-  othello_player_t **player_cursor;
-
-  status = OTHELLO_SUCCESS;
-
-  reply[0] = OTHELLO_QUERY_GIVE_UP;
-  reply[1] = OTHELLO_FAILURE;
+void othello_reactor_complete(othello_reactor_t *reactor,
+                              othello_player_t *player,
+                              struct io_uring_cqe *cqe) {
+  if (!(cqe->flags & IORING_CQE_F_MORE)) {
+    player->receiving = false;
+  }
+
+  if (cqe->res > 0) {
+    othello_metrics_count(OTHELLO_METRICS_BYTES_RECEIVED, cqe->res);
+    if (!player->closing &&
+        othello_player_feed(player,
+                            othello_uring_buffer(&(reactor->uring), cqe),
+                            cqe->res) != OTHELLO_SUCCESS) {
+      player->closing = true;
+    }
+  } else if (cqe->res != -ENOBUFS && cqe->res != -ECANCELED) {
+    player->closing = true;
+  }
 
-  notif[0] = OTHELLO_NOTIF_GIVE_UP;
+  if (cqe->flags & IORING_CQE_F_BUFFER) {
+    othello_uring_recycle(&(reactor->uring), cqe);
+  }
 
-  if (player->state == OTHELLO_STATE_IN_GAME) {
-    reply[1] = OTHELLO_SUCCESS;
-    memcpy(notif + 1, player->name, sizeof(player->name));
+  othello_reactor_settle(reactor, player);
+}
 
-    pthread_mutex_lock(&(player->room->mutex));
-    for (player_cursor = player->room->players;
-         player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
-         player_cursor++) {
-      if (*player_cursor != NULL) {
-        if (*player_cursor != player) {
-          pthread_mutex_lock(&((*player_cursor)->mutex));
-          othello_write_all((*player_cursor)->socket, notif, sizeof(notif));
-          pthread_mutex_unlock(&((*player_cursor)->mutex));
+/**
+ * completions of the listening socket carry a pointer to reactor->socket, the
+ * pipe reactor->pipe, cancels 0 and players their own pointer
+ */
+void *othello_reactor_start_uring(othello_reactor_t *reactor) {
+  struct io_uring_cqe *cqe;
+
+  while (othello_uring_submit_and_wait(&(reactor->uring)) >= 0) {
+    while ((cqe = othello_uring_peek(&(reactor->uring))) != NULL) {
+      if (cqe->user_data == (uintptr_t) & (reactor->socket)) {
+        if (cqe->res >= 0) {
+          othello_reactor_accepted(reactor, cqe->res);
         }
-        (*player_cursor)->ready = false;
-        (*player_cursor)->state = OTHELLO_STATE_IN_ROOM;
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+          othello_reactor_accept(reactor);
+        }
+      } else if (cqe->user_data == (uintptr_t)reactor->pipe) {
+        othello_reactor_read_pipe(reactor);
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+          othello_reactor_poll_pipe(reactor);
+        }
+      } else if (cqe->user_data != 0) {
+        othello_reactor_complete(reactor,
+                                 (othello_player_t *)(uintptr_t)cqe->user_data,
+                                 cqe);
       }
+      othello_uring_advance(&(reactor->uring));
     }
-    pthread_mutex_unlock(&(player->room->mutex));
-
-    othello_log(LOG_INFO, "player %p %d %s - give up", player, player->socket,
-                player->name);
   }
 
-  pthread_mutex_lock(&(player->mutex));
-  if (othello_write_all(player->socket, &reply, sizeof(reply)) <= 0) {
-    status = OTHELLO_FAILURE;
-  }
-  pthread_mutex_unlock(&(player->mutex));
+  othello_log(LOG_ERR, "reactor %p - %s", reactor, strerror(errno));
 
-  return status;
+  return NULL;
 }
 
 /**
- *
+ * the listening socket is registered with a pointer to reactor->socket, the
+ * pipe with reactor->pipe and players with their own pointer
  */
-void *othello_player_start(void *arg) {
+void *othello_reactor_start(void *arg) {
+  othello_reactor_t *reactor;
+  int events_count, socket;
+  struct epoll_event events[OTHELLO_EVENTS_LENGTH];
+  struct epoll_event *event_cursor;
   othello_player_t *player;
-  char query;
-  othello_status_t status;
 
-  player = (othello_player_t *)arg;
+  reactor = (othello_reactor_t *)arg;
 
-  othello_log(LOG_INFO, "%p %d %s - connect", player, player->socket,
-              player->name);
+  if (othello_server_io_uring) {
+    return othello_reactor_start_uring(reactor);
+  }
 
-  while (othello_read_all(player->socket, &query, sizeof(query)) > 0) {
-    switch (query) {
-    case OTHELLO_QUERY_LOGIN:
-      status = othello_handle_login(player);
-      break;
-    case OTHELLO_QUERY_ROOM_LIST:
-      status = othello_handle_room_list(player);
-      break;
-    case OTHELLO_QUERY_ROOM_JOIN:
-      status = othello_handle_room_join(player);
-      break;
-    case OTHELLO_QUERY_ROOM_LEAVE:
-      status = othello_handle_room_leave(player);
-      break;
-    case OTHELLO_QUERY_MESSAGE:
-      status = othello_handle_message(player);
-      break;
-    case OTHELLO_QUERY_READY:
-      status = othello_handle_ready(player);
-      break;
-    case OTHELLO_QUERY_NOT_READY:
-      status = othello_handle_not_ready(player);
-      break;
-    case OTHELLO_QUERY_PLAY:
-      status = othello_handle_play(player);
-      break;
-    case OTHELLO_QUERY_GIVE_UP:
-      status = othello_handle_give_up(player);
-      break;
-    case OTHELLO_QUERY_LOGOFF:;
-    default:
-      status = OTHELLO_FAILURE;
+  for (;;) {
+    if ((events_count = epoll_wait(reactor->event_fd, events,
+                                   OTHELLO_EVENTS_LENGTH, -1)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
       break;
     }
 
-    if (status != OTHELLO_SUCCESS) {
-      break;
+    for (event_cursor = events; event_cursor < events + events_count;
+         event_cursor++) {
+      if (event_cursor->data.ptr == &(reactor->socket)) {
+        while ((socket = accept4(reactor->socket, NULL, NULL, SOCK_NONBLOCK)) >=
+               0) {
+          othello_reactor_accepted(reactor, socket);
+        }
+      } else if (event_cursor->data.ptr == reactor->pipe) {
+        othello_reactor_read_pipe(reactor);
+      } else {
+        player = event_cursor->data.ptr;
+        if (othello_player_receive(player) != OTHELLO_SUCCESS) {
+          othello_reactor_close(reactor, player);
+        }
+      }
     }
   }
 
-  othello_player_end(player);
+  othello_log(LOG_ERR, "reactor %p - %s", reactor, strerror(errno));
 
   return NULL;
 }
 
+/**
+ * the calling thread runs the first reactor
+ */
+int othello_reactors_run(unsigned short port) {
+  othello_reactor_t *reactor_cursor;
+
+  if ((othello_server_reactors = calloc(othello_server_workers,
+                                        sizeof(othello_reactor_t))) == NULL) {
+    return errno;
+  }
+
+  for (reactor_cursor = othello_server_reactors;
+       reactor_cursor < othello_server_reactors + othello_server_workers;
+       reactor_cursor++) {
+    if (othello_reactor_init(reactor_cursor, port) < 0) {
+      return errno;
+    }
+  }
+
+  othello_log(LOG_INFO, "server - listen on port: %d with %d reactors", port,
+              othello_server_workers);
+
+  for (reactor_cursor = othello_server_reactors + 1;
+       reactor_cursor < othello_server_reactors + othello_server_workers;
+       reactor_cursor++) {
+    if (pthread_create(&(reactor_cursor->thread), NULL, othello_reactor_start,
+                       reactor_cursor)) {
+      return errno;
+    }
+  }
+
+  othello_reactor_start(othello_server_reactors);
+
+  return errno;
+}
+
 /**
  *
  */
-int othello_create_socket_stream(unsigned short port) {
+int othello_create_socket_stream(unsigned short port, bool reuse_port) {
   int socket_stream, status, optval;
   struct sockaddr_in address;
 
@@ -839,6 +2410,12 @@ int othello_create_socket_stream(unsigned short port) {
     return status;
   }
 
+  if (reuse_port &&
+      (status = setsockopt(socket_stream, SOL_SOCKET, SO_REUSEPORT, &optval,
+                           sizeof(int))) < 0) {
+    return status;
+  }
+
   if ((status = bind(socket_stream, (struct sockaddr *)&address,
                      sizeof(struct sockaddr_in))) < 0) {
     return status;
@@ -854,44 +2431,61 @@ void othello_exit(void) {
   if (othello_server_socket >= 0) {
     close(othello_server_socket);
   }
+  othello_log_flush();
   closelog();
-  pthread_mutex_destroy(&othello_server_log_mutex);
 }
 
 /**
  *
  */
-int othello_game_score(othello_player_t *player) {
-  int i, j, score;
-
-  score = 0;
+int othello_game_side(othello_player_t *player) {
+  othello_player_t **player_cursor;
 
-  for (i = 0; i < OTHELLO_BOARD_LENGTH; i++) {
-    for (j = 0; j < OTHELLO_BOARD_LENGTH; j++) {
-      if (player->room->grid[i][j] == player) {
-        score++;
-      }
+  for (player_cursor = player->room->players;
+       player_cursor < player->room->players + OTHELLO_ROOM_LENGTH;
+       player_cursor++) {
+    if (*player_cursor == player) {
+      break;
     }
   }
 
-  return score;
+  return player_cursor - player->room->players;
 }
 
 /**
  *
  */
-bool othello_game_able_to_play(othello_player_t *player) {
-  int i, j;
+int othello_game_score(othello_player_t *player) {
+  return player->room->scores[othello_game_side(player)];
+}
 
-  for (i = 0; i < OTHELLO_BOARD_LENGTH; i++) {
-    for (j = 0; j < OTHELLO_BOARD_LENGTH; j++) {
-      if (othello_game_is_stroke_valid(player, i, j)) {
-        return true;
-      }
+/**
+ *
+ */
+bool othello_game_is_finished(othello_player_t *player) {
+  int *score_cursor;
+  int total_score;
+
+  total_score = 0;
+
+  for (score_cursor = player->room->scores;
+       score_cursor < player->room->scores + OTHELLO_ROOM_LENGTH;
+       score_cursor++) {
+    if (*score_cursor == 0) {
+      return true;
     }
+    total_score += *score_cursor;
   }
 
-  return false;
+  return total_score == OTHELLO_BOARD_LENGTH * OTHELLO_BOARD_LENGTH;
+}
+
+/**
+ *
+ */
+bool othello_game_able_to_play(othello_player_t *player) {
+  return othello_board_moves(&(player->room->board),
+                             othello_game_side(player)) != 0;
 }
 
 /**
@@ -899,143 +2493,27 @@ bool othello_game_able_to_play(othello_player_t *player) {
  */
 othello_status_t othello_game_play_stroke(othello_player_t *player,
                                           unsigned char x, unsigned char y) {
-  int x_iter, y_iter;
+  othello_bitboard_t flips;
+  int side, flipped;
 
-  if (!othello_game_is_stroke_valid(player, x, y)) {
+  if (x >= OTHELLO_BOARD_LENGTH || y >= OTHELLO_BOARD_LENGTH) {
     return OTHELLO_FAILURE;
   }
 
-  player->room->grid[x][y] = player;
+  side = othello_game_side(player);
 
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) &&
-         player->room->grid[x_iter - 1][y_iter] != player &&
-         player->room->grid[x_iter - 1][y_iter] != NULL) {
-    --x_iter;
-  }
-  if ((x_iter - 1 >= 0)) {
-    if (player->room->grid[x_iter - 1][y_iter] == player) {
-      while (x_iter < x) {
-        player->room->grid[x_iter][y_iter] = player;
-        ++x_iter;
-      }
-    }
-  }
-  x_iter = x;
-  y_iter = y;
-  while ((y_iter + 1 <= 7) &&
-         player->room->grid[x_iter][y_iter + 1] != player &&
-         player->room->grid[x_iter][y_iter + 1] != NULL) {
-    ++y_iter;
-  }
-  if ((y_iter + 1 <= 7)) {
-    if (player->room->grid[x_iter][y_iter + 1] == player) {
-      while (y_iter > y) {
-        player->room->grid[x_iter][y_iter] = player;
-        --y_iter;
-      }
-    }
-  }
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) &&
-         player->room->grid[x_iter + 1][y_iter] != player &&
-         player->room->grid[x_iter + 1][y_iter] != NULL) {
-    ++x_iter;
-  }
-  if ((x_iter + 1 <= 7)) {
-    if (player->room->grid[x_iter + 1][y_iter] == player) {
-      while (x_iter > x) {
-        player->room->grid[x_iter][y_iter] = player;
-        --x_iter;
-      }
-    }
-  }
-  x_iter = x;
-  y_iter = y;
-  while ((y_iter - 1 >= 0) &&
-         player->room->grid[x_iter][y_iter - 1] != player &&
-         player->room->grid[x_iter][y_iter - 1] != NULL) {
-    --y_iter;
-  }
-  if ((y_iter - 1 >= 0)) {
-    if (player->room->grid[x_iter][y_iter - 1] == player) {
-      while (y_iter < y) {
-        player->room->grid[x_iter][y_iter] = player;
-        ++y_iter;
-      }
-    }
-  }
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && (y_iter + 1 <= 7) &&
-         player->room->grid[x_iter - 1][y_iter + 1] != player &&
-         player->room->grid[x_iter - 1][y_iter + 1] != NULL) {
-    --x_iter;
-    ++y_iter;
-  }
-  if ((x_iter - 1 >= 0) && (y_iter + 1 <= 7)) {
-    if (player->room->grid[x_iter - 1][y_iter + 1] == player) {
-      while (x_iter < x) {
-        player->room->grid[x_iter][y_iter] = player;
-        ++x_iter;
-        --y_iter;
-      }
-    }
-  }
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && (y_iter + 1 <= 7) &&
-         player->room->grid[x_iter + 1][y_iter + 1] != player &&
-         player->room->grid[x_iter + 1][y_iter + 1] != NULL) {
-    ++x_iter;
-    ++y_iter;
-  }
-  if ((x_iter + 1 <= 7) && (y_iter + 1 <= 7)) {
-    if (player->room->grid[x_iter + 1][y_iter + 1] == player) {
-      while (x_iter > x) {
-        player->room->grid[x_iter][y_iter] = player;
-        --x_iter;
-        --y_iter;
-      }
-    }
-  }
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && (y_iter - 1 >= 0) &&
-         player->room->grid[x_iter + 1][y_iter - 1] != player &&
-         player->room->grid[x_iter + 1][y_iter - 1] != NULL) {
-    ++x_iter;
-    --y_iter;
-  }
-  if ((x_iter + 1 <= 7) && (y_iter - 1 >= 0)) {
-    if (player->room->grid[x_iter + 1][y_iter - 1] == player) {
-      while (x_iter > x) {
-        player->room->grid[x_iter][y_iter] = player;
-        --x_iter;
-        ++y_iter;
-      }
-    }
-  }
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && (y_iter - 1 >= 0) &&
-         player->room->grid[x_iter - 1][y_iter - 1] != player &&
-         player->room->grid[x_iter - 1][y_iter - 1] != NULL) {
-    --x_iter;
-    --y_iter;
-  }
-  if ((x_iter - 1 >= 0) && (y_iter - 1 >= 0)) {
-    if (player->room->grid[x_iter - 1][y_iter - 1] == player) {
-      while (x_iter < x) {
-        player->room->grid[x_iter][y_iter] = player;
-        ++x_iter;
-        ++y_iter;
-      }
-    }
+  if ((flips = othello_board_flips(&(player->room->board), side,
+                                   OTHELLO_BOARD_SQUARE(x, y))) == 0) {
+    return OTHELLO_FAILURE;
   }
 
+  othello_board_apply(&(player->room->board), side,
+                      OTHELLO_BOARD_SQUARE(x, y), flips);
+
+  flipped = othello_bitboard_count(flips);
+  player->room->scores[side] += flipped + 1;
+  player->room->scores[!side] -= flipped;
+
   return OTHELLO_SUCCESS;
 }
 
@@ -1044,140 +2522,13 @@ othello_status_t othello_game_play_stroke(othello_player_t *player,
  */
 int othello_game_is_stroke_valid(othello_player_t *player, unsigned char x,
                                  unsigned char y) {
-  int x_iter, y_iter, nb_returned, final_returned;
-
-  nb_returned = 0;
-  final_returned = 0;
-
-  if (player->room->grid[x][y] != NULL || x >= OTHELLO_BOARD_LENGTH ||
-      y >= OTHELLO_BOARD_LENGTH) {
-    return final_returned;
-  }
-
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) &&
-         player->room->grid[x_iter - 1][y_iter] != player &&
-         player->room->grid[x_iter - 1][y_iter] != NULL) {
-    --x_iter;
-    ++nb_returned;
-  }
-  if ((x_iter - 1 >= 0)) {
-    if (player->room->grid[x_iter - 1][y_iter] == player) {
-      final_returned += nb_returned;
-    }
-  }
-
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((y_iter + 1 <= 7) &&
-         player->room->grid[x_iter][y_iter + 1] != player &&
-         player->room->grid[x_iter][y_iter + 1] != NULL) {
-    ++y_iter;
-    ++nb_returned;
-  }
-  if ((y_iter + 1 <= 7)) {
-    if (player->room->grid[x_iter][y_iter + 1] == player) {
-      final_returned += nb_returned;
-    }
-  }
-
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) &&
-         player->room->grid[x_iter + 1][y_iter] != player &&
-         player->room->grid[x_iter + 1][y_iter] != NULL) {
-    ++x_iter;
-    ++nb_returned;
-  }
-  if ((x_iter + 1 <= 7)) {
-    if (player->room->grid[x_iter + 1][y_iter] == player) {
-      final_returned += nb_returned;
-    }
-  }
-
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((y_iter - 1 >= 0) &&
-         player->room->grid[x_iter][y_iter - 1] != player &&
-         player->room->grid[x_iter][y_iter - 1] != NULL) {
-    --y_iter;
-    ++nb_returned;
-  }
-  if ((y_iter - 1 >= 0)) {
-    if (player->room->grid[x_iter][y_iter - 1] == player) {
-      final_returned += nb_returned;
-    }
-  }
-
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && (y_iter + 1 <= 7) &&
-         player->room->grid[x_iter - 1][y_iter + 1] != player &&
-         player->room->grid[x_iter - 1][y_iter + 1] != NULL) {
-    --x_iter;
-    ++y_iter;
-    ++nb_returned;
-  }
-  if ((x_iter - 1 >= 0) && (y_iter + 1 <= 7)) {
-    if (player->room->grid[x_iter - 1][y_iter + 1] == player) {
-      final_returned += nb_returned;
-    }
-  }
-
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && (y_iter + 1 <= 7) &&
-         player->room->grid[x_iter + 1][y_iter + 1] != player &&
-         player->room->grid[x_iter + 1][y_iter + 1] != NULL) {
-    ++x_iter;
-    ++y_iter;
-    ++nb_returned;
-  }
-  if ((x_iter + 1 <= 7) && (y_iter + 1 <= 7)) {
-    if (player->room->grid[x_iter + 1][y_iter + 1] == player) {
-      final_returned += nb_returned;
-    }
-  }
-
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter + 1 <= 7) && (y_iter - 1 >= 0) &&
-         player->room->grid[x_iter + 1][y_iter - 1] != player &&
-         player->room->grid[x_iter + 1][y_iter - 1] != NULL) {
-    ++x_iter;
-    --y_iter;
-    ++nb_returned;
-  }
-  if ((x_iter + 1 <= 7) && (y_iter - 1 >= 0)) {
-    if (player->room->grid[x_iter + 1][y_iter - 1] == player) {
-      final_returned += nb_returned;
-    }
-  }
-
-  nb_returned = 0;
-  x_iter = x;
-  y_iter = y;
-  while ((x_iter - 1 >= 0) && (y_iter - 1 >= 0) &&
-         player->room->grid[x_iter - 1][y_iter - 1] != player &&
-         player->room->grid[x_iter - 1][y_iter - 1] != NULL) {
-    --x_iter;
-    --y_iter;
-    ++nb_returned;
-  }
-  if ((x_iter - 1 >= 0) && (y_iter - 1 >= 0)) {
-    if (player->room->grid[x_iter - 1][y_iter - 1] == player) {
-      final_returned += nb_returned;
-    }
+  if (x >= OTHELLO_BOARD_LENGTH || y >= OTHELLO_BOARD_LENGTH) {
+    return 0;
   }
 
-  return final_returned;
+  return othello_bitboard_count(othello_board_flips(&(player->room->board),
+                                                    othello_game_side(player),
+                                                    OTHELLO_BOARD_SQUARE(x, y)));
 }
 
 /**
@@ -1199,11 +2550,23 @@ void othello_daemonize(void) {
   }
 }
 
+/**
+ * SIGUSR1 logs one more level, SIGUSR2 one less
+ */
+void othello_signal_log_level(int signal) {
+  othello_log_level_set(othello_log_level() + (signal == SIGUSR1 ? 1 : -1));
+}
+
 /**
  *
  */
 void othello_print_help(void) {
-  printf("Usage: othello-server [-p | --port <port>] [-d | --daemon]\n");
+  printf("Usage: othello-server [-p | --port <port>] [-d | --daemon] "
+         "[-e | --event-loop] [-w | --workers <count>] [-u | --io-uring] "
+         "[-o | --output <bytes>] [-D | --drop] [-r | --rooms <count>] "
+         "[-P | --players <count>] [-t | --tick <milliseconds>] "
+         "[-l | --log-level <0-7>] [-j | --journal <path prefix>] "
+         "[-J | --journal-segment <records>] [-m | --metrics <port>]\n");
 }
 
 /**
@@ -1212,19 +2575,49 @@ void othello_print_help(void) {
 int main(int argc, char *argv[]) {
   int status;
   othello_player_t *player;
-  othello_room_t *room_cursor;
+  pthread_t thread;
   unsigned short port;
   int option;
-  char *short_options = "hp:d";
+  int socket;
+  int log_level;
+  char *journal_prefix;
+  unsigned int journal_segment_length;
+  unsigned short metrics_port;
+  struct sigaction action;
+  char *short_options = "hp:dew:uo:Dr:P:t:l:j:J:m:";
   struct option long_options[] = {{"help", no_argument, NULL, 'h'},
                                   {"port", required_argument, NULL, 'p'},
                                   {"daemon", no_argument, NULL, 'd'},
+                                  {"event-loop", no_argument, NULL, 'e'},
+                                  {"workers", required_argument, NULL, 'w'},
+                                  {"io-uring", no_argument, NULL, 'u'},
+                                  {"output", required_argument, NULL, 'o'},
+                                  {"drop", no_argument, NULL, 'D'},
+                                  {"rooms", required_argument, NULL, 'r'},
+                                  {"players", required_argument, NULL, 'P'},
+                                  {"tick", required_argument, NULL, 't'},
+                                  {"log-level", required_argument, NULL, 'l'},
+                                  {"journal", required_argument, NULL, 'j'},
+                                  {"journal-segment", required_argument, NULL,
+                                   'J'},
+                                  {"metrics", required_argument, NULL, 'm'},
                                   {NULL, 0, NULL, 0}};
 
   /* init global */
   /* init socket */
   port = OTHELLO_DEFAULT_PORT;
   othello_server_daemon = false;
+  othello_server_workers = 0;
+  othello_server_io_uring = false;
+  othello_server_output_length = OTHELLO_DEFAULT_OUTPUT_LENGTH;
+  othello_server_overflow_drop = false;
+  othello_server_rooms_length = OTHELLO_DEFAULT_NUMBER_OF_ROOMS;
+  othello_server_players_length = OTHELLO_DEFAULT_NUMBER_OF_PLAYERS;
+  othello_server_lobby_tick = OTHELLO_DEFAULT_LOBBY_TICK;
+  log_level = LOG_INFO;
+  journal_prefix = NULL;
+  journal_segment_length = OTHELLO_JOURNAL_DEFAULT_SEGMENT_LENGTH;
+  metrics_port = 0;
 
   while ((option = getopt_long(argc, argv, short_options, long_options,
                                NULL)) != -1) {
@@ -1235,6 +2628,84 @@ int main(int argc, char *argv[]) {
     case 'd':
       othello_server_daemon = true;
       break;
+    case 'e':
+      if (othello_server_workers == 0) {
+        othello_server_workers = 1;
+      }
+      break;
+    case 'u':
+      othello_server_io_uring = true;
+      if (othello_server_workers == 0) {
+        othello_server_workers = 1;
+      }
+      break;
+    case 'o':
+      /*a queued frame is never split*/
+      if (optarg &&
+          sscanf(optarg, "%lu", &othello_server_output_length) == 1 &&
+          othello_server_output_length >= OTHELLO_MIN_OUTPUT_LENGTH) {
+        break;
+      }
+      othello_print_help();
+      return EXIT_FAILURE;
+    case 'D':
+      othello_server_overflow_drop = true;
+      break;
+    case 'r':
+      if (optarg && sscanf(optarg, "%u", &othello_server_rooms_length) == 1 &&
+          othello_server_rooms_length > 0 &&
+          othello_server_rooms_length <= OTHELLO_MAX_NUMBER_OF_ROOMS) {
+        break;
+      }
+      othello_print_help();
+      return EXIT_FAILURE;
+    case 't':
+      if (optarg && sscanf(optarg, "%ld", &othello_server_lobby_tick) == 1 &&
+          othello_server_lobby_tick >= 0) {
+        break;
+      }
+      othello_print_help();
+      return EXIT_FAILURE;
+    case 'l':
+      if (optarg && sscanf(optarg, "%d", &log_level) == 1 &&
+          log_level >= LOG_EMERG && log_level <= LOG_DEBUG) {
+        break;
+      }
+      othello_print_help();
+      return EXIT_FAILURE;
+    case 'j':
+      journal_prefix = optarg;
+      break;
+    case 'J':
+      if (optarg &&
+          sscanf(optarg, "%u", &journal_segment_length) == 1 &&
+          journal_segment_length > 0) {
+        break;
+      }
+      othello_print_help();
+      return EXIT_FAILURE;
+    case 'm':
+      if (optarg && sscanf(optarg, "%hu", &metrics_port) == 1 &&
+          metrics_port > 0) {
+        break;
+      }
+      othello_print_help();
+      return EXIT_FAILURE;
+    case 'P':
+      if (optarg &&
+          sscanf(optarg, "%u", &othello_server_players_length) == 1 &&
+          othello_server_players_length > 0) {
+        break;
+      }
+      othello_print_help();
+      return EXIT_FAILURE;
+    case 'w':
+      if (optarg && sscanf(optarg, "%d", &othello_server_workers) == 1 &&
+          othello_server_workers > 0) {
+        break;
+      }
+      othello_print_help();
+      return EXIT_FAILURE;
     case 'p':
       if (optarg && sscanf(optarg, "%hu", &port) == 1) {
         break;
@@ -1249,30 +2720,83 @@ int main(int argc, char *argv[]) {
     othello_daemonize();
   }
 
-  openlog(NULL, LOG_CONS | LOG_PID, LOG_USER);
-  if (pthread_mutex_init(&othello_server_log_mutex, NULL)) {
+  othello_server_socket = -1;
+
+  if (atexit(othello_exit)) {
     return EXIT_FAILURE;
   }
 
-  othello_server_socket = -1;
+  if (othello_log_init(othello_server_daemon, log_level) < 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (journal_prefix != NULL &&
+      othello_journal_init(journal_prefix, journal_segment_length) < 0) {
+    othello_log(LOG_ERR, "journal - %s", strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  if (metrics_port > 0 && othello_metrics_init(metrics_port) < 0) {
+    othello_log(LOG_ERR, "metrics - %s", strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+#ifdef OTHELLO_LOCK_PROFILE
+  if (othello_lockprof_init() < 0) {
+    othello_log(LOG_ERR, "lock profile - %s", strerror(errno));
+    return EXIT_FAILURE;
+  }
+#endif
 
+  /*rooms are allocated when a player joins them*/
   memset(othello_server_rooms, 0, sizeof(othello_server_rooms));
-  memset(othello_server_players, 0, sizeof(othello_server_players));
+  if (pthread_mutex_init(&othello_server_rooms_mutex, NULL) ||
+      pthread_mutex_init(&othello_server_room_list_mutex, NULL)) {
+    return EXIT_FAILURE;
+  }
+  othello_server_rooms_version = 0;
+  othello_server_room_list = NULL;
 
-  for (room_cursor = othello_server_rooms;
-       room_cursor < othello_server_rooms + OTHELLO_NUMBER_OF_ROOMS;
-       room_cursor++) {
-    if (pthread_mutex_init(&(room_cursor->mutex), NULL)) {
-      return EXIT_FAILURE;
-    }
+  if (othello_pool_init(&othello_server_players, sizeof(othello_player_t),
+                        othello_server_players_length) < 0) {
+    othello_log(LOG_ERR, strerror(errno));
+    return EXIT_FAILURE;
   }
 
-  if (atexit(othello_exit)) {
+  /* a player may close its socket before a reply, write then fails with EPIPE
+   */
+  if (signal(SIGPIPE, SIG_IGN) == SIG_ERR) {
+    return EXIT_FAILURE;
+  }
+
+  /*blocking calls of the other threads are restarted*/
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = othello_signal_log_level;
+  action.sa_flags = SA_RESTART;
+  if (sigaction(SIGUSR1, &action, NULL) < 0 ||
+      sigaction(SIGUSR2, &action, NULL) < 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (othello_lobby_init() < 0) {
+    othello_log(LOG_ERR, strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  if (othello_writer_init() < 0) {
+    othello_log(LOG_ERR, strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  if (othello_server_workers > 0) {
+    status = othello_reactors_run(port);
+    othello_log(LOG_ERR, strerror(status));
     return EXIT_FAILURE;
   }
 
   /* open socket */
-  if ((othello_server_socket = othello_create_socket_stream(port)) < 0) {
+  if ((othello_server_socket = othello_create_socket_stream(port, false)) <
+      0) {
     othello_log(LOG_ERR, strerror(errno));
     return EXIT_FAILURE;
   }
@@ -1285,29 +2809,25 @@ int main(int argc, char *argv[]) {
   othello_log(LOG_INFO, "server - listen on port: %d", port);
 
   for (;;) {
-    if ((player = malloc(sizeof(othello_player_t))) == NULL) {
+    if ((socket = accept(othello_server_socket, NULL, NULL)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
       status = errno;
       break;
     }
 
-    memset(player, 0, sizeof(othello_player_t));
-    if (pthread_mutex_init(&(player->mutex), NULL)) {
-      break;
-    }
-
-    if ((player->socket = accept(othello_server_socket, NULL, NULL)) < 0) {
-      break;
-    }
-
-    if (pthread_mutex_init(&(player->mutex), NULL)) {
-      break;
+    if ((player = othello_player_new(socket)) == NULL) {
+      close(socket);
+      continue;
     }
 
-    if (pthread_create(&(player->thread), NULL, othello_player_start, player)) {
+    /*the player may already be freed by its thread once it is created*/
+    if (pthread_create(&thread, NULL, othello_player_start, player)) {
       break;
     }
 
-    if (pthread_detach(player->thread)) {
+    if (pthread_detach(thread)) {
       break;
     }
   }
@@ -7,18 +7,41 @@
 
 #include <stdbool.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 struct othello_player_s;
 struct othello_room_s;
+struct othello_reactor_s;
+struct othello_batch_s;
+struct othello_rooms_page_s;
+struct othello_room_list_s;
+struct io_uring_cqe;
 
 typedef struct othello_player_s othello_player_t;
 typedef struct othello_room_s othello_room_t;
+typedef struct othello_reactor_s othello_reactor_t;
+typedef struct othello_batch_s othello_batch_t;
+typedef struct othello_rooms_page_s othello_rooms_page_t;
+typedef struct othello_room_list_s othello_room_list_t;
+
+/*with -D OTHELLO_LOCK_PROFILE, the sends pass the file and line of their call
+  so the waits for the player mutex are recorded at the handler which sent*/
+#ifdef OTHELLO_LOCK_PROFILE
+#define OTHELLO_CALLER_PARAMS , const char *caller_file, int caller_line
+#define OTHELLO_CALLER_ARGS , caller_file, caller_line
+#define OTHELLO_CALLER_HERE , __FILE__, __LINE__
+#else
+#define OTHELLO_CALLER_PARAMS
+#define OTHELLO_CALLER_ARGS
+#define OTHELLO_CALLER_HERE
+#endif
 
 /**
  * create a IPv4 TCP socket
  * \param port port to listen
+ * \param reuse_port share the port with other sockets (SO_REUSEPORT)
  */
-int othello_create_socket_stream(unsigned short port);
+int othello_create_socket_stream(unsigned short port, bool reuse_port);
 
 /**
  * read data to a given file descriptor until error or buffer filled
@@ -37,11 +60,106 @@ ssize_t othello_read_all(int fd, void *buf, size_t count);
 ssize_t othello_write_all(int fd, void *buf, size_t count);
 
 /**
- * log a message to standard output or to syslog
- * \param priority message priority (see syslog message level)
- * \param format message to log
+ * read the payload of the current query of a player from the bytes already
+ * received, the whole query is received before it is handled
+ * \param player current player
+ * \param buf buffer to fill
+ * \param count count of data to read
+ */
+ssize_t othello_player_read(othello_player_t *player, void *buf,
+                            size_t count);
+
+/**
+ * send a frame to a player without blocking, the bytes the socket does not
+ * accept are queued and sent by the writer thread
+ * \param player recipient
+ * \param buf frame to send
+ * \param count size of the frame
+ * \return OTHELLO_FAILURE on a socket error or if the output overflows with
+ * the disconnect policy
+ */
+othello_status_t othello_player_send_at(othello_player_t *player, void *buf,
+                                        size_t count OTHELLO_CALLER_PARAMS);
+#define othello_player_send(player, buf, count)                                \
+  othello_player_send_at((player), (buf), (count) OTHELLO_CALLER_HERE)
+
+/**
+ * send several frames to a player with a single system call, as
+ * othello_player_send
+ * \param player recipient
+ * \param frames frames to send
+ * \param frames_count count of frames
+ * \return OTHELLO_FAILURE on a socket error or if the output overflows with
+ * the disconnect policy
+ */
+othello_status_t othello_player_sendv_at(othello_player_t *player,
+                                         struct iovec *frames, int frames_count
+                                         OTHELLO_CALLER_PARAMS);
+#define othello_player_sendv(player, frames, frames_count)                     \
+  othello_player_sendv_at((player), (frames),                                  \
+                          (frames_count) OTHELLO_CALLER_HERE)
+
+/**
+ * start an empty batch of frames
+ * \param batch batch to initialize
+ * \param player recipient, NULL for a batch which sends nothing
+ */
+void othello_batch_init(othello_batch_t *batch, othello_player_t *player);
+
+/**
+ * append a frame to a batch, the frame is not copied and must stay valid until
+ * the batch is flushed
+ * \param batch current batch
+ * \param buf frame to send
+ * \param count size of the frame
+ */
+void othello_batch_add(othello_batch_t *batch, void *buf, size_t count);
+
+/**
+ * send every frame of a batch and empty it
+ * \param batch current batch
+ * \return the status of othello_player_sendv
+ */
+othello_status_t othello_batch_flush_at(othello_batch_t *batch
+                                        OTHELLO_CALLER_PARAMS);
+#define othello_batch_flush(batch)                                             \
+  othello_batch_flush_at((batch)OTHELLO_CALLER_HERE)
+
+/**
+ * flush the batches of every seat of a room
+ * \param batches one batch per seat
+ * \param player player who triggered the event
+ * \return OTHELLO_FAILURE if the batch of player failed
+ */
+othello_status_t othello_room_flush_at(othello_batch_t *batches,
+                                       othello_player_t *player
+                                       OTHELLO_CALLER_PARAMS);
+#define othello_room_flush(batches, player)                                    \
+  othello_room_flush_at((batches), (player)OTHELLO_CALLER_HERE)
+
+/**
+ * send the queued output of a player until the socket would block
+ * \param player current player
  */
-void othello_log(int priority, const char *format, ...);
+bool othello_player_flush(othello_player_t *player);
+
+/**
+ * drop the queued output of a player and shut its socket down
+ * \param player current player
+ */
+void othello_player_disconnect(othello_player_t *player);
+
+/**
+ * drain the output queues when their sockets become writable and free the
+ * ended players
+ */
+void *othello_writer_start(void *arg);
+
+/**
+ * start the writer thread
+ * \return a negative value on failure
+ */
+int othello_writer_init(void);
 
 /**
  * cleanup function
@@ -53,17 +171,192 @@ void othello_exit(void);
  */
 void othello_daemonize(void);
 
+/**
+ * change the log level at runtime
+ * \param signal SIGUSR1 or SIGUSR2
+ */
+void othello_signal_log_level(int signal);
+
 /**
  * print help on standard output
  */
 void othello_print_help(void);
 
+/**
+ * allocate a player for an accepted socket
+ * \param socket socket of the player
+ * \return NULL on failure
+ */
+othello_player_t *othello_player_new(int socket);
+
+/**
+ * count of bytes following a query byte
+ * \param query query to check
+ * \return -1 if the query is unknown or closes the connection
+ */
+ssize_t othello_query_length(char query);
+
+/**
+ * handle one query of the player
+ * \param player current player
+ * \param query query to handle
+ */
+othello_status_t othello_player_handle(othello_player_t *player, char query);
+
 /**
  * start to handle player queries
  * \param player current player
  */
 void *othello_player_start(void *player);
 
+/**
+ * receive the available bytes of a player, as many as its buffer holds, and
+ * handle the complete queries
+ * \param player current player
+ */
+othello_status_t othello_player_receive(othello_player_t *player);
+
+/**
+ * handle the complete queries already received from a player
+ * \param player current player
+ */
+othello_status_t othello_player_process(othello_player_t *player);
+
+/**
+ * copy received bytes to the input of a player and handle the complete
+ * queries, the bytes following a hand off are kept in the backlog of the
+ * player, io_uring only
+ * \param player current player
+ * \param buffer received bytes
+ * \param length count of received bytes
+ */
+othello_status_t othello_player_feed(othello_player_t *player,
+                                     const char *buffer, size_t length);
+
+/**
+ * feed the bytes kept in the backlog of a player handed off, io_uring only
+ * \param player current player
+ */
+othello_status_t othello_player_feed_backlog(othello_player_t *player);
+
+/**
+ * reactor owning a room, players of a room are all handled by its reactor
+ * \param room_id id of the room
+ */
+othello_reactor_t *othello_room_reactor(unsigned short room_id);
+
+/**
+ * move a player to another reactor
+ * \param reactor reactor receiving the player
+ * \param player current player
+ */
+othello_status_t othello_reactor_hand_off(othello_reactor_t *reactor,
+                                          othello_player_t *player);
+
+/**
+ * give a player to another reactor through its pipe
+ * \param reactor reactor receiving the player
+ * \param player current player
+ */
+othello_status_t othello_reactor_send(othello_reactor_t *reactor,
+                                      othello_player_t *player);
+
+/**
+ * end a player of a reactor, delayed with io_uring until its receive is over
+ * \param reactor reactor handling the player
+ * \param player current player
+ */
+void othello_reactor_close(othello_reactor_t *reactor,
+                           othello_player_t *player);
+
+/**
+ * register a player socket in a reactor
+ * \param reactor reactor handling the player
+ * \param player current player
+ */
+othello_status_t othello_reactor_add(othello_reactor_t *reactor,
+                                     othello_player_t *player);
+
+/**
+ * create the listening socket, the epoll instance and the pipe of a reactor
+ * \param reactor reactor to initialize
+ * \param port port to listen
+ * \return a negative value on failure
+ */
+int othello_reactor_init(othello_reactor_t *reactor, unsigned short port);
+
+/**
+ * create a player for an accepted socket and register it in the reactor
+ * \param reactor reactor handling the player
+ * \param socket accepted socket
+ */
+void othello_reactor_accepted(othello_reactor_t *reactor, int socket);
+
+/**
+ * register the players handed off by other reactors
+ * \param reactor reactor receiving the players
+ */
+void othello_reactor_read_pipe(othello_reactor_t *reactor);
+
+/**
+ * queue a multishot accept on the reactor listening socket, io_uring only
+ * \param reactor current reactor
+ */
+othello_status_t othello_reactor_accept(othello_reactor_t *reactor);
+
+/**
+ * queue a multishot poll on the reactor pipe, io_uring only
+ * \param reactor current reactor
+ */
+othello_status_t othello_reactor_poll_pipe(othello_reactor_t *reactor);
+
+/**
+ * queue a multishot receive of a player into the provided buffers, io_uring
+ * only
+ * \param reactor reactor handling the player
+ * \param player current player
+ */
+othello_status_t othello_reactor_receive(othello_reactor_t *reactor,
+                                         othello_player_t *player);
+
+/**
+ * cancel the receive of a closing or leaving player, end it, hand it off or
+ * restart its receive once no receive is in flight, io_uring only
+ * \param reactor reactor handling the player
+ * \param player current player
+ */
+void othello_reactor_settle(othello_reactor_t *reactor,
+                            othello_player_t *player);
+
+/**
+ * handle a receive completion of a player, io_uring only
+ * \param reactor reactor handling the player
+ * \param player current player
+ * \param cqe receive completion
+ */
+void othello_reactor_complete(othello_reactor_t *reactor,
+                              othello_player_t *player,
+                              struct io_uring_cqe *cqe);
+
+/**
+ * run the reactor on io_uring completions instead of epoll
+ * \param reactor reactor to run
+ */
+void *othello_reactor_start_uring(othello_reactor_t *reactor);
+
+/**
+ * multiplex the reactor sockets with epoll
+ * \param reactor reactor to run
+ */
+void *othello_reactor_start(void *reactor);
+
+/**
+ * start the reactors, one per worker
+ * \param port port to listen
+ * \return the error which stopped the reactors
+ */
+int othello_reactors_run(unsigned short port);
+
 /**
  * cleanup function
  * \param player current player
@@ -77,11 +370,44 @@ void othello_player_end(othello_player_t *player);
 othello_status_t othello_handle_login(othello_player_t *player);
 
 /**
- * send the list of rooms
+ * send the existing rooms from the requested id, at most
+ * OTHELLO_ROOM_LIST_LENGTH per reply, from the room list snapshot
  * \param player current player
  */
 othello_status_t othello_handle_room_list(othello_player_t *player);
 
+/**
+ * encode every existing room
+ * \return a new snapshot with one reference, NULL on allocation failure
+ */
+othello_room_list_t *othello_room_list_build(void);
+
+/**
+ * get the room list snapshot, built again if a room changed since the last one
+ * \return a reference to the snapshot, NULL on allocation failure
+ */
+othello_room_list_t *othello_room_list_acquire(void);
+
+/**
+ * give back a reference taken with othello_room_list_acquire
+ * \param room_list snapshot to give back
+ */
+void othello_room_list_release(othello_room_list_t *room_list);
+
+/**
+ * find a room or create it, and lock it
+ * \param room_id id of the room
+ * \return the locked room, NULL if the id is out of range or on allocation
+ * failure
+ */
+othello_room_t *othello_room_acquire(unsigned short room_id);
+
+/**
+ * free a room if it is empty
+ * \param room_id id of the room, the caller must not hold the room mutex
+ */
+void othello_room_release(unsigned short room_id);
+
 /**
  * put the player in a room
  * \param player current player
@@ -124,12 +450,67 @@ othello_status_t othello_handle_play(othello_player_t *player);
  */
 othello_status_t othello_handle_give_up(othello_player_t *player);
 
+/**
+ * subscribe the player to the lobby feed or unsubscribe it
+ * \param player current player
+ */
+othello_status_t othello_handle_lobby(othello_player_t *player);
+
+/**
+ * queue a lobby event for the subscribers, sent at the end of the tick
+ * \param room_id id of the room of the event
+ * \param event kind of event
+ * \param name name of the player of the event, NULL if there is none
+ */
+void othello_lobby_push(unsigned short room_id, othello_lobby_t event,
+                        const char *name);
+
+/**
+ * add the player to the lobby subscribers
+ * \param player current player
+ * \return OTHELLO_FAILURE if already subscribed or on allocation failure
+ */
+othello_status_t othello_lobby_subscribe(othello_player_t *player);
+
+/**
+ * remove the player from the lobby subscribers
+ * \param player current player
+ * \return OTHELLO_FAILURE if not subscribed
+ */
+othello_status_t othello_lobby_unsubscribe(othello_player_t *player);
+
+/**
+ * lobby thread, send the events of each tick to the subscribers
+ * \param arg unused
+ */
+void *othello_lobby_start(void *arg);
+
+/**
+ * start the lobby thread
+ * \return a negative value on failure
+ */
+int othello_lobby_init(void);
+
+/**
+ * side of the player on the room board, its index in the room
+ * \param player current player
+ */
+int othello_game_side(othello_player_t *player);
+
 /**
  * compute the score of the player
  * \param player current player
  */
 int othello_game_score(othello_player_t *player);
 
+/**
+ * check from the disc counts only if the game is finished, board full or a
+ * side without any disc
+ * \param player current player
+ * \return false does not mean that a player is able to play
+ */
+bool othello_game_is_finished(othello_player_t *player);
+
 /**
  * check if the player is able to play
  * \param player current player
@@ -0,0 +1,230 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-table.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define OTHELLO_TABLE_ALIGNMENT 64 /*size of a cache line*/
+#define OTHELLO_TABLE_BYTES 8      /*bytes of a bitboard*/
+#define OTHELLO_TABLE_SEED UINT64_C(0x9e3779b97f4a7c15)
+
+/**
+ * keys of the squares grouped by byte of a bitboard, the key of a byte is the
+ * xor of the keys of its squares so a position is hashed with one lookup per
+ * byte instead of one per disc
+ */
+static uint64_t othello_table_keys[OTHELLO_BOARD_SIDES][OTHELLO_TABLE_BYTES]
+                                  [256];
+static uint64_t othello_table_side_key;
+static bool othello_table_keys_ready;
+
+/**
+ * splitmix64, the keys are the same from one run to the next one
+ */
+static uint64_t othello_table_random(uint64_t *state) {
+  uint64_t z;
+
+  z = (*state += OTHELLO_TABLE_SEED);
+  z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+
+  return z ^ (z >> 31);
+}
+
+/**
+ *
+ */
+void othello_table_hash_init(void) {
+  uint64_t square_keys[OTHELLO_TABLE_BYTES * 8];
+  uint64_t state, key;
+  int side, byte, value, bit;
+
+  if (othello_table_keys_ready) {
+    return;
+  }
+
+  state = 0;
+  for (side = 0; side < OTHELLO_BOARD_SIDES; side++) {
+    for (bit = 0; bit < OTHELLO_TABLE_BYTES * 8; bit++) {
+      square_keys[bit] = othello_table_random(&state);
+    }
+    for (byte = 0; byte < OTHELLO_TABLE_BYTES; byte++) {
+      for (value = 0; value < 256; value++) {
+        key = 0;
+        for (bit = 0; bit < 8; bit++) {
+          if (value & (1 << bit)) {
+            key ^= square_keys[byte * 8 + bit];
+          }
+        }
+        othello_table_keys[side][byte][value] = key;
+      }
+    }
+  }
+  othello_table_side_key = othello_table_random(&state);
+  othello_table_keys_ready = true;
+}
+
+/**
+ * score on 16 bits, depth and move on 8 bits each, bound on 8 bits and
+ * generation on 8 bits
+ */
+static uint64_t othello_table_pack(int score, int depth, int move,
+                                   othello_table_bound_t bound,
+                                   unsigned int generation) {
+  return (uint64_t)(uint16_t)score | (uint64_t)(depth & 0xff) << 16 |
+         (uint64_t)(move & 0xff) << 24 | (uint64_t)(bound & 0xff) << 32 |
+         (uint64_t)(generation & 0xff) << 40;
+}
+
+/**
+ *
+ */
+static int othello_table_depth(uint64_t data) { return (data >> 16) & 0xff; }
+
+/**
+ *
+ */
+static unsigned int othello_table_generation(uint64_t data) {
+  return (data >> 40) & 0xff;
+}
+
+/**
+ *
+ */
+int othello_table_init(othello_table_t *table, size_t megabytes) {
+  size_t buckets;
+
+  othello_table_hash_init();
+
+  buckets = megabytes * 1024 * 1024 /
+            (OTHELLO_TABLE_BUCKET_ENTRIES * sizeof(othello_table_entry_t));
+  if (buckets == 0) {
+    buckets = 1;
+  }
+  while (buckets & (buckets - 1)) {
+    buckets &= buckets - 1;
+  }
+
+  if (posix_memalign((void **)&(table->entries), OTHELLO_TABLE_ALIGNMENT,
+                     buckets * OTHELLO_TABLE_BUCKET_ENTRIES *
+                         sizeof(othello_table_entry_t))) {
+    return -1;
+  }
+  table->mask = buckets - 1;
+  othello_table_clear(table);
+
+  return 0;
+}
+
+/**
+ *
+ */
+void othello_table_free(othello_table_t *table) {
+  free(table->entries);
+  table->entries = NULL;
+}
+
+/**
+ *
+ */
+void othello_table_clear(othello_table_t *table) {
+  memset(table->entries, 0,
+         (table->mask + 1) * OTHELLO_TABLE_BUCKET_ENTRIES *
+             sizeof(othello_table_entry_t));
+  table->generation = 0;
+}
+
+/**
+ *
+ */
+void othello_table_age(othello_table_t *table) {
+  table->generation = (table->generation + 1) & 0xff;
+}
+
+/**
+ *
+ */
+uint64_t othello_table_hash(const othello_board_t *board, int side) {
+  uint64_t key;
+  othello_bitboard_t black, white;
+  int byte;
+
+  key = side ? othello_table_side_key : 0;
+  black = board->discs[OTHELLO_BOARD_BLACK];
+  white = board->discs[OTHELLO_BOARD_WHITE];
+  for (byte = 0; byte < OTHELLO_TABLE_BYTES; byte++) {
+    key ^= othello_table_keys[OTHELLO_BOARD_BLACK][byte][black & 0xff] ^
+           othello_table_keys[OTHELLO_BOARD_WHITE][byte][white & 0xff];
+    black >>= 8;
+    white >>= 8;
+  }
+
+  return key;
+}
+
+/**
+ * the bucket is chosen by the low bits of the key, the entry is checked with
+ * the whole key
+ */
+bool othello_table_probe(othello_table_t *table, uint64_t key,
+                         othello_table_hit_t *hit) {
+  othello_table_entry_t *entry;
+  uint64_t check, data;
+  int i;
+
+  entry = table->entries + (key & table->mask) * OTHELLO_TABLE_BUCKET_ENTRIES;
+  for (i = 0; i < OTHELLO_TABLE_BUCKET_ENTRIES; i++, entry++) {
+    check = __atomic_load_n(&(entry->check), __ATOMIC_RELAXED);
+    data = __atomic_load_n(&(entry->data), __ATOMIC_RELAXED);
+    if ((check ^ data) == key && data != 0) {
+      hit->score = (int16_t)(data & 0xffff);
+      hit->depth = othello_table_depth(data);
+      hit->move = (data >> 24) & 0xff;
+      hit->bound = (data >> 32) & 0xff;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * entries of older searches go first, then the shallowest ones
+ */
+void othello_table_store(othello_table_t *table, uint64_t key, int score,
+                         int depth, int move, othello_table_bound_t bound) {
+  othello_table_entry_t *entry, *replaced;
+  uint64_t data, replaced_data;
+  int i, value, replaced_value;
+
+  entry = table->entries + (key & table->mask) * OTHELLO_TABLE_BUCKET_ENTRIES;
+  replaced = entry;
+  replaced_value = 0x7fffffff;
+  for (i = 0; i < OTHELLO_TABLE_BUCKET_ENTRIES; i++, entry++) {
+    data = __atomic_load_n(&(entry->data), __ATOMIC_RELAXED);
+    if ((__atomic_load_n(&(entry->check), __ATOMIC_RELAXED) ^ data) == key) {
+      /*keep the stroke of a deeper search of the same position*/
+      if (move == OTHELLO_TABLE_NO_MOVE) {
+        move = (data >> 24) & 0xff;
+      }
+      replaced = entry;
+      break;
+    }
+    value = othello_table_depth(data) -
+            (othello_table_generation(data) != table->generation ? 256 : 0);
+    if (value < replaced_value) {
+      replaced = entry;
+      replaced_value = value;
+    }
+  }
+
+  replaced_data = othello_table_pack(score, depth, move, bound,
+                                     table->generation);
+  __atomic_store_n(&(replaced->check), key ^ replaced_data, __ATOMIC_RELAXED);
+  __atomic_store_n(&(replaced->data), replaced_data, __ATOMIC_RELAXED);
+}
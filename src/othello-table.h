@@ -0,0 +1,124 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_TABLE_H
+#define OTHELLO_TABLE_H
+
+#include "othello-board.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define OTHELLO_TABLE_DEFAULT_SIZE 16 /*megabytes*/
+#define OTHELLO_TABLE_BUCKET_ENTRIES 4 /*one cache line per bucket*/
+#define OTHELLO_TABLE_NO_MOVE 0xff
+
+enum othello_table_bound_e {
+  OTHELLO_TABLE_NONE,
+  OTHELLO_TABLE_EXACT,
+  OTHELLO_TABLE_LOWER, /*the score is at least the stored one*/
+  OTHELLO_TABLE_UPPER  /*the score is at most the stored one*/
+};
+
+typedef enum othello_table_bound_e othello_table_bound_t;
+
+/**
+ * the check holds the key xor the data, an entry torn by concurrent writes
+ * does not match its key anymore
+ */
+struct othello_table_entry_s {
+  uint64_t check;
+  uint64_t data; /*score, depth, move, bound and generation*/
+};
+
+typedef struct othello_table_entry_s othello_table_entry_t;
+
+/**
+ * fixed size transposition table of buckets of entries, keyed by Zobrist hashes
+ */
+struct othello_table_s {
+  othello_table_entry_t *entries; /*aligned on a cache line*/
+  size_t mask;                    /*count of buckets - 1*/
+  unsigned int generation;        /*search of the entries to keep first*/
+};
+
+typedef struct othello_table_s othello_table_t;
+
+/**
+ * result of a probe
+ */
+struct othello_table_hit_s {
+  int score;
+  int depth;
+  int move; /*OTHELLO_TABLE_NO_MOVE if there is none*/
+  othello_table_bound_t bound;
+};
+
+typedef struct othello_table_hit_s othello_table_hit_t;
+
+/**
+ * fill the Zobrist keys, the same from one run to the next one, called by
+ * othello_table_init and before hashing without a table
+ */
+void othello_table_hash_init(void);
+
+/**
+ * allocate an empty table, the count of buckets is rounded down to a power of
+ * 2
+ * \param table table to initialize
+ * \param megabytes size of the table
+ * \return a negative value on failure
+ */
+int othello_table_init(othello_table_t *table, size_t megabytes);
+
+/**
+ * free the entries of a table
+ * \param table current table
+ */
+void othello_table_free(othello_table_t *table);
+
+/**
+ * forget every entry
+ * \param table current table
+ */
+void othello_table_clear(othello_table_t *table);
+
+/**
+ * start a new search, the entries of the previous ones are replaced first
+ * \param table current table
+ */
+void othello_table_age(othello_table_t *table);
+
+/**
+ * Zobrist hash of a position
+ * \param board current board
+ * \param side side to play
+ */
+uint64_t othello_table_hash(const othello_board_t *board, int side);
+
+/**
+ * find a position
+ * \param table current table
+ * \param key hash of the position
+ * \param hit result, set only if the position is found
+ * \return true if the position is found
+ */
+bool othello_table_probe(othello_table_t *table, uint64_t key,
+                         othello_table_hit_t *hit);
+
+/**
+ * store a position, the entry of the same position or the least useful entry
+ * of the bucket is replaced
+ * \param table current table
+ * \param key hash of the position
+ * \param score score of the position
+ * \param depth depth of the search of the position
+ * \param move best stroke, OTHELLO_TABLE_NO_MOVE if there is none
+ * \param bound kind of score
+ */
+void othello_table_store(othello_table_t *table, uint64_t key, int score,
+                         int depth, int move, othello_table_bound_t bound);
+
+#endif
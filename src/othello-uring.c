@@ -0,0 +1,207 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#define _GNU_SOURCE
+
+#include "othello-uring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ *
+ */
+int othello_uring_init(othello_uring_t *uring) {
+  struct io_uring_params params;
+  struct io_uring_buf_reg buffers_reg;
+  char *sq_ring, *cq_ring;
+  size_t sq_ring_length, cq_ring_length, buffers_length;
+  unsigned short buffer_id;
+
+  memset(uring, 0, sizeof(othello_uring_t));
+  memset(&params, 0, sizeof(params));
+
+  if ((uring->fd = syscall(__NR_io_uring_setup, OTHELLO_URING_ENTRIES,
+                           &params)) < 0) {
+    return uring->fd;
+  }
+
+  sq_ring_length = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_length =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) &&
+      cq_ring_length > sq_ring_length) {
+    sq_ring_length = cq_ring_length;
+  }
+
+  if ((sq_ring = mmap(NULL, sq_ring_length, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, uring->fd,
+                      IORING_OFF_SQ_RING)) == MAP_FAILED) {
+    return -1;
+  }
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    cq_ring = sq_ring;
+  } else if ((cq_ring = mmap(NULL, cq_ring_length, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, uring->fd,
+                             IORING_OFF_CQ_RING)) == MAP_FAILED) {
+    return -1;
+  }
+
+  if ((uring->sqes = mmap(NULL,
+                          params.sq_entries * sizeof(struct io_uring_sqe),
+                          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          uring->fd, IORING_OFF_SQES)) == MAP_FAILED) {
+    return -1;
+  }
+
+  uring->sq_head = (unsigned *)(sq_ring + params.sq_off.head);
+  uring->sq_tail = (unsigned *)(sq_ring + params.sq_off.tail);
+  uring->sq_mask = (unsigned *)(sq_ring + params.sq_off.ring_mask);
+  uring->sq_array = (unsigned *)(sq_ring + params.sq_off.array);
+  uring->cq_head = (unsigned *)(cq_ring + params.cq_off.head);
+  uring->cq_tail = (unsigned *)(cq_ring + params.cq_off.tail);
+  uring->cq_mask = (unsigned *)(cq_ring + params.cq_off.ring_mask);
+  uring->cqes = (struct io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+
+  /*ring of provided buffers, page aligned as required by the kernel*/
+  buffers_length = OTHELLO_URING_BUFFERS * sizeof(struct io_uring_buf);
+  if ((uring->buffers = mmap(NULL, buffers_length, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) ==
+      MAP_FAILED) {
+    return -1;
+  }
+  if ((uring->buffers_data =
+           mmap(NULL, OTHELLO_URING_BUFFERS * OTHELLO_URING_BUFFER_LENGTH,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) ==
+      MAP_FAILED) {
+    return -1;
+  }
+
+  memset(&buffers_reg, 0, sizeof(buffers_reg));
+  buffers_reg.ring_addr = (uint64_t)(uintptr_t)uring->buffers;
+  buffers_reg.ring_entries = OTHELLO_URING_BUFFERS;
+  buffers_reg.bgid = OTHELLO_URING_BUFFER_GROUP;
+  if (syscall(__NR_io_uring_register, uring->fd, IORING_REGISTER_PBUF_RING,
+              &buffers_reg, 1) < 0) {
+    return -1;
+  }
+
+  for (buffer_id = 0; buffer_id < OTHELLO_URING_BUFFERS; buffer_id++) {
+    uring->buffers->bufs[buffer_id].addr =
+        (uint64_t)(uintptr_t)(uring->buffers_data +
+                              buffer_id * OTHELLO_URING_BUFFER_LENGTH);
+    uring->buffers->bufs[buffer_id].len = OTHELLO_URING_BUFFER_LENGTH;
+    uring->buffers->bufs[buffer_id].bid = buffer_id;
+  }
+  uring->buffers_tail = OTHELLO_URING_BUFFERS;
+  __atomic_store_n(&(uring->buffers->tail), uring->buffers_tail,
+                   __ATOMIC_RELEASE);
+
+  return 0;
+}
+
+/**
+ *
+ */
+struct io_uring_sqe *othello_uring_prepare(othello_uring_t *uring,
+                                           uint8_t opcode, int fd,
+                                           uint64_t user_data) {
+  struct io_uring_sqe *sqe;
+  unsigned tail, index;
+
+  tail = *(uring->sq_tail);
+  if (tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE) >
+      *(uring->sq_mask)) {
+    if (syscall(__NR_io_uring_enter, uring->fd, uring->sq_pending, 0, 0, NULL,
+                0) < 0) {
+      return NULL;
+    }
+    uring->sq_pending = 0;
+    if (tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE) >
+        *(uring->sq_mask)) {
+      return NULL;
+    }
+  }
+
+  index = tail & *(uring->sq_mask);
+  sqe = uring->sqes + index;
+  memset(sqe, 0, sizeof(struct io_uring_sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->user_data = user_data;
+
+  uring->sq_array[index] = index;
+  __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  uring->sq_pending++;
+
+  return sqe;
+}
+
+/**
+ *
+ */
+int othello_uring_submit_and_wait(othello_uring_t *uring) {
+  int status;
+
+  if ((status = syscall(__NR_io_uring_enter, uring->fd, uring->sq_pending, 1,
+                        IORING_ENTER_GETEVENTS, NULL, 0)) < 0) {
+    return (errno == EINTR) ? 0 : status;
+  }
+  uring->sq_pending = 0;
+
+  return 0;
+}
+
+/**
+ *
+ */
+struct io_uring_cqe *othello_uring_peek(othello_uring_t *uring) {
+  unsigned head;
+
+  head = *(uring->cq_head);
+  if (head == __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+    return NULL;
+  }
+
+  return uring->cqes + (head & *(uring->cq_mask));
+}
+
+/**
+ *
+ */
+void othello_uring_advance(othello_uring_t *uring) {
+  __atomic_store_n(uring->cq_head, *(uring->cq_head) + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ *
+ */
+char *othello_uring_buffer(othello_uring_t *uring, struct io_uring_cqe *cqe) {
+  return uring->buffers_data + (cqe->flags >> IORING_CQE_BUFFER_SHIFT) *
+                                   OTHELLO_URING_BUFFER_LENGTH;
+}
+
+/**
+ *
+ */
+void othello_uring_recycle(othello_uring_t *uring, struct io_uring_cqe *cqe) {
+  struct io_uring_buf *buffer;
+  unsigned short buffer_id;
+
+  buffer_id = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+  buffer =
+      uring->buffers->bufs + (uring->buffers_tail & (OTHELLO_URING_BUFFERS - 1));
+  buffer->addr = (uint64_t)(uintptr_t)(uring->buffers_data +
+                                       buffer_id * OTHELLO_URING_BUFFER_LENGTH);
+  buffer->len = OTHELLO_URING_BUFFER_LENGTH;
+  buffer->bid = buffer_id;
+
+  uring->buffers_tail++;
+  __atomic_store_n(&(uring->buffers->tail), uring->buffers_tail,
+                   __ATOMIC_RELEASE);
+}
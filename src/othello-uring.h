@@ -0,0 +1,94 @@
+/**
+ * \author Alexis Giraudet
+ */
+
+#ifndef OTHELLO_URING_H
+#define OTHELLO_URING_H
+
+#include <linux/io_uring.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define OTHELLO_URING_ENTRIES 1024
+#define OTHELLO_URING_BUFFERS 512 /*must be a power of 2*/
+#define OTHELLO_URING_BUFFER_LENGTH 2048
+#define OTHELLO_URING_BUFFER_GROUP 0
+
+/**
+ * io_uring instance with a ring of provided buffers for multishot receives
+ */
+struct othello_uring_s {
+  int fd;
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  struct io_uring_sqe *sqes;
+  unsigned sq_pending; /*queued entries not yet submitted*/
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned *cq_mask;
+  struct io_uring_cqe *cqes;
+  struct io_uring_buf_ring *buffers;
+  char *buffers_data;
+  unsigned short buffers_tail;
+};
+
+typedef struct othello_uring_s othello_uring_t;
+
+/**
+ * create the rings and register the provided buffers
+ * \param uring io_uring to initialize
+ * \return a negative value on failure
+ */
+int othello_uring_init(othello_uring_t *uring);
+
+/**
+ * get a cleared submission entry, queued entries are submitted first if the
+ * submission ring is full
+ * \param uring current io_uring
+ * \param opcode operation of the entry
+ * \param fd file descriptor of the operation
+ * \param user_data value given back with the completions
+ * \return NULL if the ring stays full
+ */
+struct io_uring_sqe *othello_uring_prepare(othello_uring_t *uring,
+                                           uint8_t opcode, int fd,
+                                           uint64_t user_data);
+
+/**
+ * submit every queued entry and wait for at least one completion with a single
+ * system call
+ * \param uring current io_uring
+ * \return a negative value on failure
+ */
+int othello_uring_submit_and_wait(othello_uring_t *uring);
+
+/**
+ * oldest unread completion
+ * \param uring current io_uring
+ * \return NULL if there is no completion
+ */
+struct io_uring_cqe *othello_uring_peek(othello_uring_t *uring);
+
+/**
+ * mark the oldest completion as read
+ * \param uring current io_uring
+ */
+void othello_uring_advance(othello_uring_t *uring);
+
+/**
+ * data of the provided buffer used by a receive completion
+ * \param uring current io_uring
+ * \param cqe receive completion
+ */
+char *othello_uring_buffer(othello_uring_t *uring, struct io_uring_cqe *cqe);
+
+/**
+ * give back the provided buffer of a receive completion to the kernel
+ * \param uring current io_uring
+ * \param cqe receive completion
+ */
+void othello_uring_recycle(othello_uring_t *uring, struct io_uring_cqe *cqe);
+
+#endif
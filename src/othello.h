@@ -5,15 +5,37 @@
 #ifndef OTHELLO_H
 #define OTHELLO_H
 
-#define OTHELLO_PROTOCOL_VERSION 2
+#define OTHELLO_PROTOCOL_VERSION 7
 
 #define OTHELLO_DEFAULT_PORT 5000
 #define OTHELLO_BOARD_LENGTH 8
-#define OTHELLO_NUMBER_OF_ROOMS 32
-#define OTHELLO_NUMBER_OF_PLAYERS 128
+#define OTHELLO_DEFAULT_NUMBER_OF_ROOMS 32
+#define OTHELLO_DEFAULT_NUMBER_OF_PLAYERS 128
+#define OTHELLO_MAX_NUMBER_OF_ROOMS 65535
 #define OTHELLO_PLAYER_NAME_LENGTH 32
 #define OTHELLO_ROOM_LENGTH 2
 #define OTHELLO_MESSAGE_LENGTH 256
+#define OTHELLO_ROOM_LIST_LENGTH 32 /*rooms per room list reply*/
+
+/**
+ * room ids are sent on 2 bytes, most significant byte first
+ */
+#define OTHELLO_ROOM_ID_LENGTH 2
+#define OTHELLO_ROOM_ID_GET(buf)                                               \
+  ((unsigned short)(((unsigned char)(buf)[0] << 8) | (unsigned char)(buf)[1]))
+#define OTHELLO_ROOM_ID_SET(buf, id)                                           \
+  ((buf)[0] = ((id) >> 8) & 0xff, (buf)[1] = (id)&0xff)
+
+/**
+ * the queries of a logged in player are framed: the length of the query and
+ * its payload on 2 bytes, most significant byte first, then the query, the
+ * login query is never framed so a client of any version gets its reply
+ */
+#define OTHELLO_FRAME_HEADER_LENGTH 2
+#define OTHELLO_FRAME_LENGTH_GET(buf)                                          \
+  ((unsigned short)(((unsigned char)(buf)[0] << 8) | (unsigned char)(buf)[1]))
+#define OTHELLO_FRAME_LENGTH_SET(buf, length)                                  \
+  ((buf)[0] = ((length) >> 8) & 0xff, (buf)[1] = (length)&0xff)
 
 enum othello_query_e {
   OTHELLO_QUERY_LOGIN,
@@ -36,7 +58,22 @@ enum othello_query_e {
   OTHELLO_NOTIF_YOUR_TURN,
   OTHELLO_NOTIF_GAME_START,
   OTHELLO_NOTIF_GAME_END,
-  OTHELLO_NOTIF_GIVE_UP
+  OTHELLO_NOTIF_GIVE_UP,
+
+  OTHELLO_QUERY_LOBBY,
+  OTHELLO_NOTIF_LOBBY
+};
+
+/**
+ * room changes pushed to the players subscribed to the lobby
+ */
+enum othello_lobby_e {
+  OTHELLO_LOBBY_ROOM_JOIN,
+  OTHELLO_LOBBY_ROOM_LEAVE,
+  OTHELLO_LOBBY_READY,
+  OTHELLO_LOBBY_NOT_READY,
+  OTHELLO_LOBBY_GAME_START,
+  OTHELLO_LOBBY_GAME_END
 };
 
 enum othello_state_e {
@@ -50,6 +87,7 @@ enum othello_status_e { OTHELLO_SUCCESS, OTHELLO_FAILURE };
 
 typedef enum othello_query_e othello_query_t;
 typedef enum othello_state_e othello_state_t;
+typedef enum othello_lobby_e othello_lobby_t;
 typedef enum othello_status_e othello_status_t;
 
 #endif